@@ -1,9 +1,19 @@
-from ctypes import CDLL, c_char_p, c_bool
+from ctypes import CDLL, c_char_p, c_void_p, c_bool, string_at
 
-q_render = CDLL("./Build/QLib.so").qentem_render_template
+q_lib = CDLL("./Build/QLib.so")
 # Use QLib.dll on Windows.
-q_render.restype = c_char_p
-q_render.argtypes = [c_char_p, c_char_p, c_bool]
+q_lib.qentem_render_template.restype = c_void_p
+q_lib.qentem_render_template.argtypes = [c_char_p, c_char_p, c_bool]
+q_lib.qentem_free.argtypes = [c_void_p]
+
+
+def q_render(template, json_text, comments):
+    # Copy the rendered text, then free it with qentem_free().
+    rendered = q_lib.qentem_render_template(template, json_text, comments)
+    text = string_at(rendered)
+    q_lib.qentem_free(rendered)
+    return text
+
 
 tempale = """
 <loop set="numbers" value="this_number">
@@ -31,8 +31,19 @@ extern "C" {
 EMSCRIPTEN_KEEPALIVE
 #endif
 
+// The rendered text is the caller's; free it with qentem_free(), not free() or delete. It is allocated with new, whatever
+// allocator the calling thread has set.
 DllExport char *qentem_render_template(const char *temp, const char *json, bool comments) {
+    const Qentem::Memory::AllocatorScope global(nullptr);
     Document data = Document::FromJSON(json, 0, String::Count(json), comments);
     return Qentem::Template::Render(temp, 0, String::Count(temp), &data).Eject();
 }
+
+#ifdef __EMSCRIPTEN__
+EMSCRIPTEN_KEEPALIVE
+#endif
+
+DllExport void qentem_free(char *str) {
+    Qentem::Memory::Deallocate<char>(&str);
+}
 }
@@ -1,4 +1,3 @@
-
 /**
  * Qentem Array
  *
@@ -16,6 +15,18 @@
 
 namespace Qentem {
 
+template <typename Type>
+struct Array;
+
+// Arrays hold no pointer into themselves.
+namespace Memory {
+template <typename Type>
+struct Relocatable<Array<Type>> {
+    static const bool Value = true;
+};
+} // namespace Memory
+
+// Only the first Size items of Storage are constructed; the rest of the Capacity is raw memory.
 template <typename Type>
 struct Array {
     UNumber Size{0};
@@ -25,39 +36,40 @@ struct Array {
     explicit Array() = default;
 
     explicit Array(UNumber capacity) noexcept : Capacity(capacity) {
-        Memory::Allocate<Type>(&Storage, Capacity);
+        Memory::Reserve<Type>(&Storage, Capacity);
     }
 
     Array(Array<Type> &&src) noexcept : Size(src.Size), Storage(src.Storage), Capacity(src.Capacity) {
-        // src.Size     = 0;
-        src.Storage = nullptr;
-        // src.Capacity = 0;
+        src.Size     = 0;
+        src.Storage  = nullptr;
+        src.Capacity = 0;
     }
 
     explicit Array(const Array<Type> &src) noexcept : Capacity(src.Size) {
         if (src.Size != 0) {
-            Memory::Allocate<Type>(&Storage, Capacity);
+            Memory::Reserve<Type>(&Storage, Capacity);
 
             for (UNumber i = 0; i < src.Size; i++) {
-                Storage[Size++] = src[i];
+                new (Storage + i) Type(src[i]);
             }
+
+            Size = src.Size;
         }
     }
 
     Array<Type> &Add(Array<Type> &&src) noexcept {
         if (Capacity == 0) {
+            Memory::Release<Type>(&Storage);
+
             Size     = src.Size;
             Storage  = src.Storage;
             Capacity = src.Capacity;
         } else {
-            const UNumber nSize = (Size + src.Size);
-            if (nSize > Capacity) {
-                Resize(nSize);
-            }
+            Reserve(Size + src.Size);
+            relocate((Storage + Size), src.Storage, src.Size);
+            Size += src.Size;
 
-            for (UNumber i = 0; i < src.Size; i++) {
-                Storage[Size++] = static_cast<Type &&>(src[i]);
-            }
+            Memory::Release<Type>(&(src.Storage));
         }
 
         src.Size     = 0;
@@ -68,65 +80,121 @@ struct Array {
     }
 
     Array<Type> &Add(const Array<Type> &src) noexcept {
-        const UNumber nSize = (Size + src.Size);
-
-        if (nSize > Capacity) {
-            Resize(nSize);
-        }
+        Reserve(Size + src.Size);
 
         for (UNumber i = 0; i < src.Size; i++) {
-            Storage[Size++] = src[i];
+            new (Storage + Size) Type(src[i]);
+            ++Size;
         }
 
         return *this;
     }
 
     Array<Type> &Add(Type &&item) noexcept { // Move
+        Emplace(static_cast<Type &&>(item));
+        return *this;
+    }
+
+    Array<Type> &Add(const Type &item) noexcept { // Copy
+        Emplace(item);
+        return *this;
+    }
+
+    // Constructs an item at the end, from the arguments of one of its constructors; they can be items of the array itself.
+    template <typename... Args>
+    Type &Emplace(Args &&... args) noexcept {
         if (Size == Capacity) {
-            Resize(Capacity * 2);
-        }
+            Type *        old      = Storage;
+            const UNumber capacity = ((Capacity != 0) ? (Capacity * 2) : 2);
 
-        Storage[Size++] = static_cast<Type &&>(item);
+            Memory::Reserve<Type>(&Storage, capacity);
+            new (Storage + Size) Type(static_cast<Args &&>(args)...);
+            relocate(Storage, old, Size);
+            Memory::Release<Type>(&old);
 
-        return *this;
+            Capacity = capacity;
+        } else {
+            new (Storage + Size) Type(static_cast<Args &&>(args)...);
+        }
+
+        return Storage[Size++];
     }
 
-    Array<Type> &Add(const Type &item) noexcept { // Copy
+    // Puts item at index, after moving the items from there on up by one.
+    void Insert(const UNumber index, Type &&item) noexcept {
+        if (index >= Size) {
+            Emplace(static_cast<Type &&>(item));
+            return;
+        }
+
+        Type tmp(static_cast<Type &&>(item)); // It may be in the array.
+
         if (Size == Capacity) {
             Resize(Capacity * 2);
         }
 
-        Storage[Size++] = item;
+        shift((Storage + index + 1), (Storage + index), (Size - index));
+        new (Storage + index) Type(static_cast<Type &&>(tmp));
+        ++Size;
+    }
 
-        return *this;
+    void Insert(const UNumber index, const Type &item) noexcept {
+        Insert(index, Type(item));
+    }
+
+    // Destroys the item at index, and moves the ones after it down by one.
+    void Remove(const UNumber index) noexcept {
+        if (index < Size) {
+            Storage[index].~Type();
+            --Size;
+            shift((Storage + index), (Storage + index + 1), (Size - index));
+        }
     }
 
     void SetCapacity(const UNumber size) noexcept {
-        Memory::Deallocate<Type>(&Storage);
+        destroy(0);
+        Memory::Release<Type>(&Storage);
 
-        Size     = 0;
         Capacity = size;
 
-        Memory::Allocate<Type>(&Storage, Capacity);
+        Memory::Reserve<Type>(&Storage, Capacity);
     }
 
+    // Makes room for size items; it may drop some from the end.
     void Resize(const UNumber size) noexcept {
-        Capacity  = ((size != 0) ? size : 2);
+        Capacity = ((size != 0) ? size : 2);
+
+        if (Size > Capacity) {
+            destroy(Capacity);
+        }
+
         Type *tmp = Storage;
-        Memory::Allocate<Type>(&Storage, Capacity);
+        Memory::Reserve<Type>(&Storage, Capacity);
+        relocate(Storage, tmp, Size);
+        Memory::Release<Type>(&tmp);
+    }
 
-        for (UNumber n = 0; n < Size; n++) {
-            Storage[n] = static_cast<Type &&>(tmp[n]);
+    // Makes room for size items, if there is not enough.
+    inline void Reserve(const UNumber size) noexcept {
+        if (size > Capacity) {
+            Resize(size);
         }
+    }
 
-        Memory::Deallocate<Type>(&tmp);
+    // Makes it hold size items; the new ones are value initialized (zeros, for plain types).
+    void Expand(const UNumber size) noexcept {
+        Reserve(size);
+
+        while (Size < size) {
+            new (Storage + Size) Type();
+            ++Size;
+        }
     }
 
     Array<Type> &operator=(Array<Type> &&src) noexcept {
         if (this != &src) {
-            if (Storage != nullptr) {
-                Memory::Deallocate<Type>(&Storage);
-            }
+            destroy(0);
+            Memory::Release<Type>(&Storage);
 
             Size         = src.Size;
             Storage      = src.Storage;
@@ -141,15 +209,7 @@ struct Array {
 
     Array<Type> &operator=(const Array<Type> &src) noexcept {
         if (this != &src) {
-            const UNumber nSize = (Size + src.Size);
-
-            if (nSize > Capacity) {
-                Resize(nSize);
-            }
-
-            for (UNumber i = 0; i < src.Size; i++) {
-                Storage[Size++] = src[i];
-            }
+            Add(src);
         }
 
         return *this;
@@ -172,9 +232,9 @@ struct Array {
     }
 
     inline void Reset() noexcept {
-        Memory::Deallocate<Type>(&Storage);
+        destroy(0);
+        Memory::Release<Type>(&Storage);
 
-        Size     = 0;
         Capacity = 0;
     }
 
@@ -183,7 +243,49 @@ struct Array {
     }
 
     ~Array() noexcept {
-        Memory::Deallocate<Type>(&Storage);
+        destroy(0);
+        Memory::Release<Type>(&Storage);
+    }
+
+    // Destroys the items from "from" to the end.
+    void destroy(const UNumber from) noexcept {
+        while (Size > from) {
+            Storage[--Size].~Type();
+        }
+    }
+
+    // Moves count items to raw memory that does not overlap them.
+    static void relocate(Type *to, Type *from, const UNumber count) noexcept {
+        if (Memory::Relocatable<Type>::Value) {
+            if (count != 0) {
+                Memory::Copy(to, from, (count * sizeof(Type)));
+            }
+        } else {
+            for (UNumber i = 0; i < count; i++) {
+                new (to + i) Type(static_cast<Type &&>(from[i]));
+                from[i].~Type();
+            }
+        }
+    }
+
+    // Moves count items by one place, up or down; the place that they go to is raw memory, and so is the one that they leave.
+    static void shift(Type *to, Type *from, const UNumber count) noexcept {
+        if (Memory::Relocatable<Type>::Value) {
+            if (count != 0) {
+                Memory::Move(to, from, (count * sizeof(Type)));
+            }
+        } else if (to > from) {
+            for (UNumber i = count; i != 0;) {
+                --i;
+                new (to + i) Type(static_cast<Type &&>(from[i]));
+                from[i].~Type();
+            }
+        } else {
+            for (UNumber i = 0; i < count; i++) {
+                new (to + i) Type(static_cast<Type &&>(from[i]));
+                from[i].~Type();
+            }
+        }
     }
 };
 
@@ -8,22 +8,84 @@
  * @license   https://opensource.org/licenses/MIT
  */
 
+#include "Platform.hpp"
+#include "Sink.hpp"
 #include "StringStream.hpp"
 
 #ifndef QENTEM_ENGINE_H
 #define QENTEM_ENGINE_H
 
+// The default of MatchTree::MaxDepth: how deep matches can nest.
+#ifndef QENTEM_MAX_DEPTH
+#define QENTEM_MAX_DEPTH 16384
+#endif
+
 namespace Qentem {
+namespace Engine {
+struct MatchBit;
+struct CompactBit;
+} // namespace Engine
+
+namespace Memory {
+template <>
+struct KindOf<Engine::MatchBit> {
+    static const Kind Value = MatchK;
+};
+
+template <>
+struct KindOf<Engine::CompactBit> {
+    static const Kind Value = MatchK;
+};
+} // namespace Memory
+
 namespace Engine {
 /////////////////////////////////
 struct MatchBit;
+struct MatchList;
+struct MatchTree;
 struct Expression;
+struct Expressions;
 /////////////////////////////////
-static void split(Array<MatchBit> &items, const char *content, UNumber offset, UNumber endOffset, UNumber count) noexcept;
+template <typename Tree>
+static void split(Tree &tree, UNumber level, const char *content, UNumber offset, UNumber endOffset, UNumber count) noexcept;
+static void ParseTo(Sink &sink, const MatchList &items, const char *content, UNumber offset, UNumber limit, void *other = nullptr) noexcept;
 using MatchCB_ = void(const char *content, UNumber &offset, const UNumber endOffset, MatchBit &item, Array<MatchBit> &items);
 using ParseCB_ = String(const char *content, const MatchBit &item, const UNumber length, void *other);
+using ParseToCB_ = void(Sink &sink, const char *content, const MatchBit &item, const UNumber length, void *other);
+using ScanCB_ = UNumber(const Expressions &expres, const char *content, UNumber offset, const UNumber endOffset);
+using VisitCB_ = void(const char *content, const MatchBit &item, const UShort event, void *other);
 
-using Expressions = Array<Expression *>;
+/////////////////////////////////
+// A set of expressions, with a first-byte dispatch table that lets match() jump to the next byte that can start a head.
+struct Expressions : Array<Expression *> {
+    mutable unsigned char Leads[256]{};  // (ID + 1) of the first expression whose head starts with that byte; 0: none.
+    mutable unsigned char Bytes[8]{};    // The distinct bytes that heads start with, for vector scanning.
+    mutable UShort        BytesCount{0}; // The number of distinct first bytes; more than 8 means scalar scanning.
+    mutable ScanCB_ *     Scan{nullptr}; // The vector scanner for BytesCount bytes; nullptr: scalar scanning.
+    mutable UNumber       Compiled{0};   // The size of the set when Leads was built.
+
+    Expressions() = default;
+
+    explicit Expressions(UNumber capacity) noexcept : Array<Expression *>(capacity) {
+    }
+
+    Expressions &Add(Expression *expr) noexcept {
+        Array<Expression *>::Add(expr);
+        Compile();
+        return *this;
+    }
+
+    Expressions &Add(const Expressions &src) noexcept {
+        Array<Expression *>::Add(src);
+        Compile();
+        return *this;
+    }
+
+    // Builds the dispatch table; Add() calls it, so a set that is built with it is only read by matching. A set that changes
+    // in size any other way (+=, Insert()) is compiled by the first match that reaches it, which writes to it: call Compile()
+    // before threads share it. Call it directly, too, after changing the head of an expression that is already in a set.
+    void Compile() const noexcept;
+};
 /////////////////////////////////
 // Expressions flags
 struct Flags {
@@ -42,6 +104,13 @@ struct Flags {
     static const UShort BUBBLE = 128; // Parse nested matches.
 };
 /////////////////////////////////
+// Visit() events
+struct Events {
+    static const UShort MATCH = 1; // A match that nothing has been visited inside.
+    static const UShort ENTER = 2; // The start of a match that its nested expressions are visited next; Length is not known yet.
+    static const UShort LEAVE = 4; // The end of an entered match; Length is 0 if it has no tail after all.
+};
+/////////////////////////////////
 struct Expression {
     UNumber     HLength{0};    // Head length.
     const char *Head{nullptr}; // The start of the match.
@@ -56,6 +125,7 @@ struct Expression {
     // After match
     UShort      ID{0};                // Expression ID.
     ParseCB_ *  ParseCB{nullptr};     // A callback function for custom rendering.
+    ParseToCB_ *ParseToCB{nullptr};   // Like ParseCB, but it writes into the output; it comes before ParseCB.
     UNumber     RLength{0};           // Replace length.
     const char *ReplaceWith{nullptr}; // A text to replace a match.
 
@@ -75,190 +145,1405 @@ struct Expression {
     }
 };
 /////////////////////////////////
+#if defined(QENTEM_SSE2)
+// Skips every block of content that none of the lead bytes of the set is in, and returns where it stopped; findLead() does the
+// rest. Count is BytesCount; it is a template parameter, so the compiler unrolls the compares for every set.
+template <UShort Count>
+static UNumber scanLead(const Expressions &expres, const char *content, UNumber offset, const UNumber endOffset) noexcept {
+    UShort       k;
+    unsigned int bits;
+
+#if defined(QENTEM_AVX2)
+    __m256i wide[Count];
+
+    for (k = 0; k < Count; k++) {
+        wide[k] = _mm256_set1_epi8(static_cast<char>(expres.Bytes[k]));
+    }
+
+    while ((offset + 32) <= endOffset) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(content + offset));
+        __m256i       found = _mm256_cmpeq_epi8(block, wide[0]);
+
+        for (k = 1; k < Count; k++) {
+            found = _mm256_or_si256(found, _mm256_cmpeq_epi8(block, wide[k]));
+        }
+
+        bits = static_cast<unsigned int>(_mm256_movemask_epi8(found));
+
+        if (bits != 0) {
+            return (offset + Platform::CTZ(bits));
+        }
+
+        offset += 32;
+    }
+#endif
+
+    __m128i leads[Count];
+
+    for (k = 0; k < Count; k++) {
+        leads[k] = _mm_set1_epi8(static_cast<char>(expres.Bytes[k]));
+    }
+
+    while ((offset + 16) <= endOffset) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(content + offset));
+        __m128i       found = _mm_cmpeq_epi8(block, leads[0]);
+
+        for (k = 1; k < Count; k++) {
+            found = _mm_or_si128(found, _mm_cmpeq_epi8(block, leads[k]));
+        }
+
+        bits = static_cast<unsigned int>(_mm_movemask_epi8(found));
+
+        if (bits != 0) {
+            return (offset + Platform::CTZ(bits));
+        }
+
+        offset += 16;
+    }
+
+    return offset;
+}
+#endif
+
+// The scanner that Compile() picks for a set with that many lead bytes.
+static ScanCB_ *getScan(const UShort count) noexcept {
+    switch (count) {
+#if defined(QENTEM_SSE2)
+        case 1:
+            return &(scanLead<1>);
+        case 2:
+            return &(scanLead<2>);
+        case 3:
+            return &(scanLead<3>);
+        case 4:
+            return &(scanLead<4>);
+        case 5:
+            return &(scanLead<5>);
+        case 6:
+            return &(scanLead<6>);
+        case 7:
+            return &(scanLead<7>);
+        case 8:
+            return &(scanLead<8>);
+#endif
+        default:
+            return nullptr;
+    }
+}
+/////////////////////////////////
+inline void Expressions::Compile() const noexcept {
+    UNumber c;
+
+    for (c = 0; c < 256; c++) {
+        Leads[c] = 0;
+    }
+
+    // Backward, so the first expression of a shared byte wins.
+    for (UNumber i = Size; i != 0;) {
+        --i;
+
+        if (Storage[i]->HLength != 0) {
+            Leads[static_cast<unsigned char>(Storage[i]->Head[0])] = static_cast<unsigned char>((i < 255) ? (i + 1) : 255);
+        }
+    }
+
+    BytesCount = 0;
+
+    for (c = 0; c < 256; c++) {
+        if (Leads[c] != 0) {
+            if (BytesCount < 8) {
+                Bytes[BytesCount] = static_cast<unsigned char>(c);
+            }
+
+            ++BytesCount;
+        }
+    }
+
+    Scan = getScan(BytesCount);
+
+    Compiled = Size;
+}
+/////////////////////////////////
+// Returns the offset of the next byte that a head in the set starts with, or endOffset.
+static UNumber findLead(const Expressions &expres, const char *content, UNumber offset, const UNumber endOffset) noexcept {
+    if ((expres.Scan != nullptr) && ((offset + 16) <= endOffset) && (expres.Leads[static_cast<unsigned char>(content[offset])] == 0)) {
+        offset = expres.Scan(expres, content, offset, endOffset);
+    }
+
+    while ((offset < endOffset) && (expres.Leads[static_cast<unsigned char>(content[offset])] == 0)) {
+        ++offset;
+    }
+
+    return offset;
+}
+/////////////////////////////////
+// Returns the offset right after the first occurrence of the tail of expr within [offset, maxOffset), or 0.
+// Candidates are the positions where both the first and the last byte of the tail match, 16/32 at a time;
+// a one byte tail is a plain byte search, and anything longer is verified at each candidate.
+static UNumber findTail(const Expression *expr, const char *content, UNumber offset, const UNumber maxOffset) noexcept {
+    const char *  tail   = expr->Tail;
+    const UNumber length = expr->TLength;
+    const UNumber last   = (length - 1);
+    UNumber       i;
+
+    if ((offset + last) >= maxOffset) {
+        return 0;
+    }
+
+#if defined(QENTEM_SSE2)
+    unsigned int bits;
+
+#if defined(QENTEM_AVX2)
+    const __m256i first32 = _mm256_set1_epi8(tail[0]);
+    const __m256i last32  = _mm256_set1_epi8(tail[last]);
+
+    while ((offset + last + 32) <= maxOffset) {
+        const __m256i block1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(content + offset));
+        const __m256i block2 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(content + offset + last));
+
+        bits = static_cast<unsigned int>(
+            _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(block1, first32), _mm256_cmpeq_epi8(block2, last32))));
+
+        while (bits != 0) {
+            const UNumber at = (offset + Platform::CTZ(bits));
+
+            for (i = 1; (i < last) && (tail[i] == content[at + i]); i++) {
+            }
+
+            if (i >= last) {
+                return (at + length);
+            }
+
+            bits &= (bits - 1);
+        }
+
+        offset += 32;
+    }
+#endif
+
+    const __m128i first16 = _mm_set1_epi8(tail[0]);
+    const __m128i last16  = _mm_set1_epi8(tail[last]);
+
+    while ((offset + last + 16) <= maxOffset) {
+        const __m128i block1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(content + offset));
+        const __m128i block2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(content + offset + last));
+
+        bits = static_cast<unsigned int>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block1, first16), _mm_cmpeq_epi8(block2, last16))));
+
+        while (bits != 0) {
+            const UNumber at = (offset + Platform::CTZ(bits));
+
+            for (i = 1; (i < last) && (tail[i] == content[at + i]); i++) {
+            }
+
+            if (i >= last) {
+                return (at + length);
+            }
+
+            bits &= (bits - 1);
+        }
+
+        offset += 16;
+    }
+#endif
+
+    while ((offset + last) < maxOffset) {
+        if ((content[offset] == tail[0]) && (content[offset + last] == tail[last])) {
+            for (i = 1; (i < last) && (tail[i] == content[offset + i]); i++) {
+            }
+
+            if (i >= last) {
+                return (offset + length);
+            }
+        }
+
+        ++offset;
+    }
+
+    return 0;
+}
+/////////////////////////////////
+// A run of matches; the storage belongs to the MatchTree that holds them.
+struct MatchList {
+    MatchBit *Storage{nullptr};
+    UNumber   Size{0};
+
+    inline MatchBit &operator[](UNumber index) const noexcept;
+};
+/////////////////////////////////
 struct MatchBit {
     UNumber           Offset{0};   // The start of the match.
     UNumber           Length{0};   // The length of the entire match.
-    Array<MatchBit>   NestMatch{}; // To hold sub matches inside a match.
+    MatchList         NestMatch{}; // Sub matches inside a match.
     const Expression *Expr{nullptr};
 };
+
+inline MatchBit &MatchList::operator[](const UNumber index) const noexcept {
+    return Storage[index];
+}
+/////////////////////////////////
+// A level of match() that waits for a level nested in it to finish; match() keeps them in tree.Frames instead of recursing.
+struct MatchFrame {
+    const Expressions *Expres{nullptr};
+    const Expression * Expr{nullptr}; // The match that is looking for its tail.
+    UNumber            Level{0};      // Where the items of the level start in tree.Stack.
+    UNumber            Started{0};
+    UNumber            Offset{0};
+    UNumber            EndOffset{0};
+    UNumber            MaxOffset{0};
+    UNumber            CurrentOffset{0};
+    UNumber            NestStart{0}; // Where the sub matches of Expr start in tree.Stack.
+    UNumber            TailEnd{0};   // The tail that the nested level ends at.
+    UNumber            SplitNest{0};  // Split matches among the sub matches of Expr.
+    UNumber            SplitCount{0}; // Split matches of the level.
+    UShort             ExprID{0};
+};
+/////////////////////////////////
+// A level of Visit() that waits for a level nested in it to finish.
+struct VisitFrame {
+    const Expressions *Expres{nullptr};
+    const Expression * Expr{nullptr}; // The entered match.
+    UNumber            Offset{0};
+    UNumber            EndOffset{0};
+    UNumber            TailEnd{0};
+    UNumber            LastEnd{0}; // Where the last match of the level ends; 0: none yet.
+    UNumber            NestEnd{0}; // Where the last match inside Expr ends; 0: none yet.
+    UShort             ExprID{0};
+};
+/////////////////////////////////
+// The first occurrence of a tail at or after From; nested matches look for the tail that their parent has just found.
+struct TailHit {
+    const char *Tail{nullptr};
+    UNumber     Length{0};
+    UNumber     From{0};
+    UNumber     End{0}; // Right after the occurrence.
+};
+
+// The last tails found, so deep nesting does not search for the same tail again at every level.
+struct TailCache {
+    TailHit Hits[4]{};
+    UShort  Next{0};
+
+    void Reset() noexcept {
+        for (UShort i = 0; i < 4; i++) {
+            Hits[i].Tail = nullptr;
+        }
+    }
+};
+/////////////////////////////////
+// The result of Match(): the top level matches are in Stack, and the sub matches of every match are one run inside a few big
+// blocks, so the whole tree takes a handful of allocations, and it is freed at once.
+struct MatchTree : MatchList {
+    using Bit = MatchBit;
+
+    static const UNumber MaxContent = ~static_cast<UNumber>(0);
+
+    Array<MatchBit>   Stack{};       // Matches that wait for their parent to close; only the top level is left at the end.
+    Array<MatchBit *> Blocks{};      // The arena.
+    MatchBit *        Next{nullptr}; // The free part of the last block.
+    UNumber           Room{0};       // The number of free matches in the last block.
+    Array<MatchFrame> Frames{};      // The levels that wait for a nested one.
+    TailCache         Tails{};
+    UNumber           MaxDepth{QENTEM_MAX_DEPTH}; // How deep matches can nest.
+    UNumber           StreamEnd{0}; // MatchStream: the end of the content received so far; 0 when the content is whole.
+    UNumber           Resume{0};    // MatchStream: where the top level match that ran into StreamEnd starts.
+    bool              Starved{false};
+    bool              TooDeep{false}; // The content nests deeper than MaxDepth; nothing has been matched.
+
+    MatchTree() = default;
+
+    MatchTree(MatchTree &&src) noexcept
+        : MatchList(src), Stack(static_cast<Array<MatchBit> &&>(src.Stack)), Blocks(static_cast<Array<MatchBit *> &&>(src.Blocks)),
+          Next(src.Next), Room(src.Room), Frames(static_cast<Array<MatchFrame> &&>(src.Frames)), MaxDepth(src.MaxDepth),
+          StreamEnd(src.StreamEnd), Resume(src.Resume), Starved(src.Starved), TooDeep(src.TooDeep) {
+        src.Storage = nullptr;
+        src.Size    = 0;
+        src.Next    = nullptr;
+        src.Room    = 0;
+    }
+
+    MatchTree(const MatchTree &src) = delete;
+    MatchTree &operator=(const MatchTree &src) = delete;
+
+    MatchTree &operator=(MatchTree &&src) noexcept {
+        if (this != &src) {
+            Reset();
+
+            Storage = src.Storage;
+            Size    = src.Size;
+            Stack   = static_cast<Array<MatchBit> &&>(src.Stack);
+            Blocks  = static_cast<Array<MatchBit *> &&>(src.Blocks);
+
+            Frames    = static_cast<Array<MatchFrame> &&>(src.Frames);
+            Next      = src.Next;
+            Room      = src.Room;
+            MaxDepth  = src.MaxDepth;
+            StreamEnd = src.StreamEnd;
+            Resume    = src.Resume;
+            Starved   = src.Starved;
+            TooDeep   = src.TooDeep;
+
+            src.Storage = nullptr;
+            src.Size    = 0;
+            src.Next    = nullptr;
+            src.Room    = 0;
+        }
+
+        return *this;
+    }
+
+    ~MatchTree() noexcept {
+        Reset();
+    }
+
+    // Copies Stack[from, to) into the arena, as the sub matches of one match.
+    MatchList Collect(const UNumber from, const UNumber to) noexcept {
+        MatchList list;
+        list.Size = (to - from);
+
+        if (list.Size != 0) {
+            if (list.Size > Room) {
+                // Every new block is twice the last one, up to 64K matches.
+                Room = (static_cast<UNumber>(16) << ((Blocks.Size < 12) ? Blocks.Size : 12));
+
+                if (Room < list.Size) {
+                    Room = list.Size;
+                }
+
+                Memory::Allocate<MatchBit>(&Next, Room);
+                Blocks += Next;
+            }
+
+            list.Storage = Next;
+
+            for (UNumber i = from; i < to; i++) {
+                *(Next++) = Stack[i];
+            }
+
+            Room -= list.Size;
+        }
+
+        return list;
+    }
+
+    void Reset() noexcept {
+        for (UNumber i = 0; i < Blocks.Size; i++) {
+            Memory::Deallocate<MatchBit>(&(Blocks[i]));
+        }
+
+        Blocks.Size = 0;
+        Stack.Size  = 0;
+        Frames.Size = 0;
+        Storage     = nullptr;
+        Size        = 0;
+        Next        = nullptr;
+        Room        = 0;
+        TooDeep     = false;
+
+        Tails.Reset();
+    }
+
+    // What match() and split() need from a tree; CompactTree has the same.
+    inline static const Expression *ExprOf(const MatchBit &item) noexcept {
+        return item.Expr;
+    }
+
+    inline static void Set(MatchBit &item, const UNumber offset, const UNumber length, const Expression *expr) noexcept {
+        item.Offset = offset;
+        item.Length = length;
+        item.Expr   = expr;
+    }
+
+    inline void Nest(MatchBit &item, const UNumber from, const UNumber to) noexcept {
+        item.NestMatch = Collect(from, to);
+    }
+
+    inline void Call(const Expression *expr, const char *content, UNumber &offset, const UNumber endOffset, MatchBit &item) noexcept {
+        expr->MatchCB(content, offset, endOffset, item, Stack);
+    }
+
+    // The top level matches are the tree.
+    inline void Close() noexcept {
+        Storage = Stack.Storage;
+        Size    = Stack.Size;
+    }
+};
+/////////////////////////////////
+// A match in 20 bytes instead of 40, for content under 4 GB: 32-bit offsets, the index of its expression in CompactTree::Exprs
+// instead of a pointer, and its sub matches as a range of CompactTree::Nodes.
+struct CompactBit {
+    unsigned int Offset{0};
+    unsigned int Length{0};
+    unsigned int First{0}; // Where its sub matches start in Nodes.
+    unsigned int Count{0}; // The number of its sub matches.
+    UShort       ExprIndex{0};
+};
 /////////////////////////////////
-static UNumber match(Array<MatchBit> &items, const Expressions &expres, const char *content, UNumber offset, const UNumber endOffset,
-                     const UNumber maxOffset, UNumber &split_count) noexcept {
-    const UNumber started    = offset;
-    UNumber       split_nest = 0;
-    MatchBit      item;
+// Match() into a CompactTree gives the tree that a MatchTree holds, in half the memory, for grammars that only read their matches
+// (Parse() needs a MatchTree). The top level matches are in Stack, and the sub matches of a match are Count matches at
+// SubMatches(). Sub matches are kept in blocks, like MatchTree does; First counts slots of 1024 matches, so a block of n slots
+// is in Slots n times. A MatchCB gets its match without the sub matches, and the matches that it adds hold them.
+struct CompactTree {
+    using Bit = CompactBit;
+
+    static const UNumber MaxContent = 0xFFFFFFFF;
+    static const UNumber SlotShift  = 10;
+
+    Array<CompactBit>         Stack{};
+    Array<CompactBit *>       Blocks{};
+    Array<CompactBit *>       Slots{};  // Slots[First >> SlotShift] is where a range starts.
+    UNumber                   Used{0};  // The index of the free part of the last block.
+    UNumber                   Room{0};  // The number of free matches in the last block.
+    Array<const Expression *> Exprs{};  // The expressions of the matches.
+    Array<MatchBit>           Called{}; // What the last MatchCB has added.
+    Array<MatchFrame>         Frames{};
+    TailCache                 Tails{};
+    UNumber                   MaxDepth{QENTEM_MAX_DEPTH};
+    UNumber                   StreamEnd{0};
+    UNumber                   Resume{0};
+    bool                      Starved{false};
+    bool                      TooDeep{false};
+
+    CompactTree() = default;
+
+    CompactTree(CompactTree &&src) noexcept
+        : Stack(static_cast<Array<CompactBit> &&>(src.Stack)), Blocks(static_cast<Array<CompactBit *> &&>(src.Blocks)),
+          Slots(static_cast<Array<CompactBit *> &&>(src.Slots)), Used(src.Used), Room(src.Room),
+          Exprs(static_cast<Array<const Expression *> &&>(src.Exprs)), Called(static_cast<Array<MatchBit> &&>(src.Called)),
+          Frames(static_cast<Array<MatchFrame> &&>(src.Frames)), MaxDepth(src.MaxDepth), StreamEnd(src.StreamEnd), Resume(src.Resume),
+          Starved(src.Starved), TooDeep(src.TooDeep) {
+        src.Used = 0;
+        src.Room = 0;
+    }
+
+    CompactTree(const CompactTree &src) = delete;
+    CompactTree &operator=(const CompactTree &src) = delete;
+
+    CompactTree &operator=(CompactTree &&src) noexcept {
+        if (this != &src) {
+            Reset();
+
+            Stack  = static_cast<Array<CompactBit> &&>(src.Stack);
+            Blocks = static_cast<Array<CompactBit *> &&>(src.Blocks);
+            Slots  = static_cast<Array<CompactBit *> &&>(src.Slots);
+            Exprs  = static_cast<Array<const Expression *> &&>(src.Exprs);
+            Called = static_cast<Array<MatchBit> &&>(src.Called);
+            Frames = static_cast<Array<MatchFrame> &&>(src.Frames);
+
+            Used      = src.Used;
+            Room      = src.Room;
+            MaxDepth  = src.MaxDepth;
+            StreamEnd = src.StreamEnd;
+            Resume    = src.Resume;
+            Starved   = src.Starved;
+            TooDeep   = src.TooDeep;
+
+            src.Used = 0;
+            src.Room = 0;
+        }
+
+        return *this;
+    }
+
+    ~CompactTree() noexcept {
+        Reset();
+    }
+
+    inline const CompactBit *SubMatches(const CompactBit &item) const noexcept {
+        if (item.Count == 0) {
+            return nullptr;
+        }
+
+        return (Slots[(item.First >> SlotShift)] + (item.First & ((1U << SlotShift) - 1)));
+    }
+
+    inline const Expression *ExprOf(const CompactBit &item) const noexcept {
+        return Exprs[item.ExprIndex];
+    }
+
+    void Set(CompactBit &item, const UNumber offset, const UNumber length, const Expression *expr) noexcept {
+        item.Offset = static_cast<unsigned int>(offset);
+        item.Length = static_cast<unsigned int>(length);
+
+        // Grammars have a handful of expressions.
+        UShort id = 0;
+
+        while ((id < Exprs.Size) && (Exprs[id] != expr)) {
+            ++id;
+        }
+
+        if (id == Exprs.Size) {
+            Exprs += expr;
+        }
+
+        item.ExprIndex = id;
+    }
+
+    // Copies Stack[from, to) into the blocks, as the sub matches of item.
+    void Nest(CompactBit &item, const UNumber from, const UNumber to) noexcept {
+        item.First = 0;
+        item.Count = static_cast<unsigned int>(to - from);
+
+        if (item.Count == 0) {
+            return;
+        }
+
+        if (item.Count > Room) {
+            // Every new block is twice the last one, up to 64 slots; a bigger range gets a block of its own size.
+            UNumber slots = (static_cast<UNumber>(1) << ((Blocks.Size < 6) ? Blocks.Size : 6));
+            UNumber need  = ((item.Count + (1U << SlotShift) - 1) >> SlotShift);
+
+            if (slots < need) {
+                slots = need;
+            }
+
+            CompactBit *block;
+            Memory::Allocate<CompactBit>(&block, (slots << SlotShift));
+            Blocks += block;
+
+            Used = (Slots.Size << SlotShift);
+            Room = (slots << SlotShift);
+
+            for (UNumber i = 0; i < slots; i++) {
+                Slots += (block + (i << SlotShift));
+            }
+        }
+
+        item.First = static_cast<unsigned int>(Used);
+
+        CompactBit *next = (Slots[(Used >> SlotShift)] + (Used & ((1U << SlotShift) - 1)));
+
+        for (UNumber i = from; i < to; i++) {
+            *(next++) = Stack.Storage[i];
+        }
+
+        Used += item.Count;
+        Room -= item.Count;
+    }
+
+    void Call(const Expression *expr, const char *content, UNumber &offset, const UNumber endOffset, CompactBit &item) noexcept {
+        MatchBit   bit;
+        CompactBit added;
+
+        bit.Offset  = item.Offset;
+        bit.Length  = item.Length;
+        bit.Expr    = expr;
+        Called.Size = 0;
+
+        expr->MatchCB(content, offset, endOffset, bit, Called);
+
+        for (UNumber i = 0; i < Called.Size; i++) {
+            Set(added, Called[i].Offset, Called[i].Length, Called[i].Expr);
+            added.First = item.First;
+            added.Count = item.Count;
+            Stack += added;
+        }
+    }
 
-    const Expression *expr;
+    // Stack is the top level already.
+    inline void Close() const noexcept {
+    }
+
+    void Reset() noexcept {
+        for (UNumber i = 0; i < Blocks.Size; i++) {
+            Memory::Deallocate<CompactBit>(&(Blocks[i]));
+        }
+
+        Blocks.Size = 0;
+        Slots.Size  = 0;
+        Used        = 0;
+        Room        = 0;
+        Stack.Size  = 0;
+        Exprs.Size  = 0;
+        Frames.Size = 0;
+        TooDeep     = false;
+
+        Tails.Reset();
+    }
+};
+/////////////////////////////////
+// findTail(), with what the levels above have found.
+static UNumber findTail(TailCache &cache, const Expression *expr, const char *content, const UNumber offset,
+                       const UNumber maxOffset) noexcept {
+    TailHit *hit = nullptr;
+
+    for (UShort i = 0; i < 4; i++) {
+        if ((cache.Hits[i].Tail == expr->Tail) && (cache.Hits[i].Length == expr->TLength)) {
+            hit = &(cache.Hits[i]);
+
+            if ((hit->From <= offset) && ((hit->End - hit->Length) >= offset)) {
+                return ((hit->End <= maxOffset) ? hit->End : 0);
+            }
+
+            break;
+        }
+    }
+
+    const UNumber end = findTail(expr, content, offset, maxOffset);
+
+    if (end != 0) {
+        if (hit == nullptr) {
+            hit = &(cache.Hits[(cache.Next++ & 3)]);
+        }
+
+        hit->Tail   = expr->Tail;
+        hit->Length = expr->TLength;
+        hit->From   = offset;
+        hit->End    = end;
+    }
+
+    return end;
+}
+/////////////////////////////////
+// Matches into tree.Stack; the items of this level are the ones from "level" to the end of the stack. Nesting does not recurse:
+// the level that a nested one is in waits on tree.Frames until it is done. Tree is MatchTree or CompactTree.
+template <typename Tree>
+static UNumber match(Tree &tree, UNumber level, const Expressions &expres, const char *content, UNumber offset, UNumber endOffset,
+                     UNumber maxOffset, UNumber &split_count) noexcept {
+    const UNumber      base        = tree.Frames.Size; // The frames under it belong to an outer call (split() matching its pieces).
+    const Expressions *exps        = &expres;
+    UNumber            started     = offset;
+    UNumber            level_split = 0; // The split matches of this level.
+    UNumber            split_nest  = 0; // The split matches among the sub matches of the current match.
+    UNumber            nest_start  = 0; // Where the sub matches of the current match start in tree.Stack.
+    UNumber            sub_offset  = 0; // Where matching inside the current match has stopped.
+    UNumber            tail_end    = 0;
+    typename Tree::Bit item;
+
+    const Expression *expr = nullptr;
     UShort            keyword_offset;
     UShort            expr_id        = 0;
     UNumber           current_offset = 0;
+    UNumber           result         = 0;     // What the last level has returned.
+    bool              resumed        = false; // Back from a nested level, to the tail search of expr.
+    bool              ended          = false; // The level returns result, without trying POP.
+    bool              nesting        = false; // A nested level is next.
+    bool              streaming;
 
-    while (offset < endOffset) {
-        current_offset = offset;
-        expr           = expres[expr_id];
-        keyword_offset = 0;
+    for (;;) {
+        streaming = ((tree.StreamEnd != 0) && (maxOffset == tree.StreamEnd)); // More content may come after maxOffset.
 
-        while ((keyword_offset < expr->HLength) && (expr->Head[keyword_offset] == content[current_offset])) {
-            ++current_offset;
-            ++keyword_offset;
+        if (exps->Compiled != exps->Size) {
+            exps->Compile();
         }
 
-        if ((keyword_offset == 0) || (keyword_offset != expr->HLength)) {
-            if (expres.Size == (++expr_id)) {
-                expr_id = 0;
-                ++offset;
+        while (offset < endOffset) {
+            if (!resumed) {
+                if (expr_id == 0) {
+                    // Skipping every byte that no head starts with.
+                    offset = findLead(*exps, content, offset, endOffset);
+
+                    if (offset == endOffset) {
+                        current_offset = (offset - 1); // As if every byte has been tried.
+                        break;
+                    }
+
+                    expr_id = static_cast<UShort>(exps->Leads[static_cast<unsigned char>(content[offset])] - 1);
+                }
+
+                current_offset = offset;
+                expr           = (*exps)[expr_id];
+                keyword_offset = 0;
+
+                while ((keyword_offset < expr->HLength) && (expr->Head[keyword_offset] == content[current_offset])) {
+                    ++current_offset;
+                    ++keyword_offset;
+                }
+
+                if ((keyword_offset == 0) || (keyword_offset != expr->HLength)) {
+                    if (streaming && (current_offset >= maxOffset)) {
+                        // A head that may go on in the next chunk.
+                        tree.Starved = true;
+                        tree.Resume  = offset;
+                        result       = 0;
+                        ended        = true;
+                        break;
+                    }
+
+                    if (exps->Size == (++expr_id)) {
+                        expr_id = 0;
+                        ++offset;
+                    }
+                    continue;
+                }
+
+                nest_start = tree.Stack.Size;
+                sub_offset = current_offset;
             }
-            continue;
-        }
 
-        if (expr->TLength != 0) {
-            UNumber sub_offset = current_offset;
-            keyword_offset     = 0;
+            if (expr->TLength != 0) {
+                keyword_offset = 0;
+
+                for (;;) {
+                    if (resumed) {
+                        resumed    = false;
+                        sub_offset = result;
+
+                        if (tree.Starved || tree.TooDeep) {
+                            tree.Stack.Size = nest_start;
+                            tree.Resume     = offset;
+                            result          = 0;
+                            ended           = true;
+                            break;
+                        }
+                    } else {
+                        tail_end = findTail(tree.Tails, expr, content, current_offset, maxOffset);
+
+                        if (tail_end == 0) {
+                            break;
+                        }
 
-            while (current_offset != maxOffset) {
-                if (expr->Tail[keyword_offset++] != content[current_offset++]) {
-                    keyword_offset = 0;
-                } else if (expr->TLength == keyword_offset) {
-                    if ((expr->NestExpres.Size != 0) && ((sub_offset + keyword_offset) != current_offset)) {
-                        sub_offset = match(item.NestMatch, expr->NestExpres, content, sub_offset, current_offset, maxOffset, split_nest);
+                        if ((expr->NestExpres.Size != 0) && ((sub_offset + expr->TLength) != tail_end)) {
+                            if (tree.Frames.Size >= tree.MaxDepth) {
+                                tree.TooDeep    = true;
+                                tree.Stack.Size = nest_start;
+                                result          = 0;
+                                ended           = true;
+                                break;
+                            }
+
+                            // Matching inside it, up to the tail; this level waits.
+                            if (tree.Frames.Size == tree.Frames.Capacity) {
+                                tree.Frames.Resize((tree.Frames.Capacity < 16) ? 16 : (tree.Frames.Capacity * 2));
+                            }
+
+                            MatchFrame *frame    = &(tree.Frames[tree.Frames.Size++]);
+                            frame->Expres        = exps;
+                            frame->Expr          = expr;
+                            frame->Level         = level;
+                            frame->Started       = started;
+                            frame->Offset        = offset;
+                            frame->EndOffset     = endOffset;
+                            frame->MaxOffset     = maxOffset;
+                            frame->CurrentOffset = current_offset;
+                            frame->NestStart     = nest_start;
+                            frame->TailEnd       = tail_end;
+                            frame->SplitNest     = split_nest;
+                            frame->SplitCount    = level_split;
+                            frame->ExprID        = expr_id;
+
+                            exps           = &(expr->NestExpres);
+                            level          = nest_start;
+                            started        = sub_offset;
+                            offset         = sub_offset;
+                            endOffset      = tail_end;
+                            current_offset = 0;
+                            level_split    = 0;
+                            split_nest     = 0;
+                            expr_id        = 0;
+                            nesting        = true;
+                            break;
+                        }
                     }
 
-                    if (current_offset > sub_offset) {
+                    if (tail_end > sub_offset) {
+                        current_offset = tail_end;
+                        keyword_offset = 1; // Found.
                         break;
                     }
 
-                    keyword_offset = 0;
+                    // The tail was inside a nested match; search again after it.
                     current_offset = sub_offset;
                 }
-            }
 
-            if (keyword_offset == 0) {
-                if (item.NestMatch.Size != 0) {
-                    split_count += split_nest;
-                    split_nest          = 0;
-                    MatchBit *sub_match = &(item.NestMatch[(item.NestMatch.Size - 1)]);
-                    items += static_cast<Array<MatchBit> &&>(item.NestMatch);
-                    offset  = (sub_match->Offset + sub_match->Length);
-                    expr_id = 0;
-                } else if (expres.Size == (++expr_id)) {
-                    expr_id = 0;
-                    ++offset;
+                if (nesting || ended) {
+                    break;
                 }
 
-                continue;
-            }
-        }
+                if (keyword_offset == 0) {
+                    if (streaming) {
+                        // The tail may be in the next chunk.
+                        tree.Starved    = true;
+                        tree.Stack.Size = nest_start;
+                        tree.Resume     = offset;
+                        result          = 0;
+                        ended           = true;
+                        break;
+                    }
 
-        if ((Flags::IGNORE & expr->Flag) == 0) {
-            item.Offset = offset;
-            item.Length = (current_offset - offset);
-            item.Expr   = expr;
+                    current_offset = maxOffset; // Every byte up to maxOffset has been searched.
 
-            if ((Flags::SPLIT & expr->Flag) != 0) {
-                ++split_count;
-            }
+                    if (tree.Stack.Size != nest_start) {
+                        // The sub matches stay, as matches of this level.
+                        level_split += split_nest;
+                        split_nest                          = 0;
+                        const typename Tree::Bit *sub_match = &(tree.Stack[(tree.Stack.Size - 1)]);
+                        offset                              = (sub_match->Offset + sub_match->Length);
+                        expr_id                             = 0;
+                    } else if (exps->Size == (++expr_id)) {
+                        expr_id = 0;
+                        ++offset;
+                    }
 
-            if (split_nest != 0) {
-                split(item.NestMatch, content, (offset + expr->HLength), (current_offset - expr->TLength), split_nest);
-                split_nest = 0;
+                    continue;
+                }
             }
 
-            if (expr->MatchCB == nullptr) {
-                items += static_cast<MatchBit &&>(item);
+            if ((Flags::IGNORE & expr->Flag) == 0) {
+                if (split_nest != 0) {
+                    split(tree, nest_start, content, (offset + expr->HLength), (current_offset - expr->TLength), split_nest);
+                    split_nest = 0;
+
+                    if (tree.TooDeep) {
+                        tree.Stack.Size = nest_start;
+                        result          = 0;
+                        ended           = true;
+                        break;
+                    }
+                }
+
+                tree.Set(item, offset, (current_offset - offset), expr);
+                tree.Nest(item, nest_start, tree.Stack.Size);
+                tree.Stack.Size = nest_start;
+
+                if ((Flags::SPLIT & expr->Flag) != 0) {
+                    ++level_split;
+                }
+
+                if (expr->MatchCB == nullptr) {
+                    tree.Stack += item;
+                } else if (streaming && (current_offset >= maxOffset)) {
+                    // The callback would look at content that has not come yet.
+                    tree.Starved    = true;
+                    tree.Stack.Size = nest_start;
+                    tree.Resume     = offset;
+                    result          = 0;
+                    ended           = true;
+                    break;
+                } else {
+                    tree.Call(expr, content, current_offset, endOffset, item);
+                }
+
+                if ((Flags::ONCE & expr->Flag) != 0) {
+                    result = current_offset;
+                    ended  = true;
+                    break;
+                }
             } else {
-                expr->MatchCB(content, current_offset, endOffset, item, items);
+                // An ignored match takes its sub matches with it.
+                tree.Stack.Size = nest_start;
+                split_nest      = 0;
             }
 
-            if ((Flags::ONCE & expr->Flag) != 0) {
-                return current_offset;
+            expr_id = 0;
+            offset  = current_offset;
+        }
+
+        if (nesting) {
+            nesting = false;
+            continue;
+        }
+
+        if (!ended) {
+            if ((exps->Size != 0) && ((Flags::POP & (*exps)[0]->Flag) != 0) && (tree.Stack.Size == level)) {
+                // Matching the level again, with the nested expressions of its first expression.
+                exps           = &((*exps)[0]->NestExpres);
+                maxOffset      = endOffset;
+                offset         = started;
+                current_offset = 0;
+                split_nest     = 0;
+                expr_id        = 0;
+                continue;
             }
+
+            result = current_offset;
         }
 
-        expr_id = 0;
-        offset  = current_offset;
-    }
+        ended = false;
 
-    if (((Flags::POP & expres[0]->Flag) != 0) && (items.Size == 0)) {
-        return match(items, expres[0]->NestExpres, content, started, endOffset, endOffset, split_count);
-    }
+        if (tree.Frames.Size == base) {
+            split_count += level_split;
+            return result;
+        }
 
-    return current_offset;
+        // Back to the level that it is nested in.
+        const MatchFrame *frame = &(tree.Frames[--tree.Frames.Size]);
+        split_nest              = (frame->SplitNest + level_split);
+        exps                    = frame->Expres;
+        expr                    = frame->Expr;
+        level                   = frame->Level;
+        started                 = frame->Started;
+        offset                  = frame->Offset;
+        endOffset               = frame->EndOffset;
+        maxOffset               = frame->MaxOffset;
+        current_offset          = frame->CurrentOffset;
+        nest_start              = frame->NestStart;
+        tail_end                = frame->TailEnd;
+        level_split             = frame->SplitCount;
+        expr_id                 = frame->ExprID;
+        resumed                 = true;
+    }
 }
 /////////////////////////////////
-static Array<MatchBit> Match(const Expressions &expres, const char *content, const UNumber offset, const UNumber limit) noexcept {
-    UNumber         split_count = 0;
-    const UNumber   endOffset   = (offset + limit);
-    Array<MatchBit> items;
+// Adds the matches of [offset, endOffset) to the end of tree.Stack.
+template <typename Tree>
+static void matchAll(Tree &tree, const Expressions &expres, const char *content, const UNumber offset, const UNumber endOffset) noexcept {
+    const UNumber level       = tree.Stack.Size;
+    UNumber       split_count = 0;
+
+    match(tree, level, expres, content, offset, endOffset, endOffset, split_count);
 
-    match(items, expres, content, offset, endOffset, endOffset, split_count);
+    if (tree.TooDeep) {
+        tree.Stack.Size = level;
+        return;
+    }
 
     if (split_count != 0) {
-        split(items, content, offset, endOffset, split_count);
+        split(tree, level, content, offset, endOffset, split_count);
     }
+}
+/////////////////////////////////
+// Matches into a tree that can be used again, or that has a different MaxDepth; content that nests deeper than MaxDepth sets
+// TooDeep, and leaves the tree empty. Tree is MatchTree, or CompactTree for half the memory; content that ends after
+// Tree::MaxContent is not matched.
+template <typename Tree>
+static void Match(Tree &tree, const Expressions &expres, const char *content, const UNumber offset, const UNumber limit) noexcept {
+    tree.Reset();
+
+    if ((offset + limit) <= Tree::MaxContent) {
+        matchAll(tree, expres, content, offset, (offset + limit));
+    }
+
+    tree.Close();
+}
+
+static MatchTree Match(const Expressions &expres, const char *content, const UNumber offset, const UNumber limit) noexcept {
+    MatchTree tree;
+    Match(tree, expres, content, offset, limit);
+    return tree;
+}
+/////////////////////////////////
+// Matches without building a tree: every match goes to visit() once it is found, in the order of the content. Matches of IGNORE
+// expressions, and everything inside them, are not visited; SPLIT, POP and MatchCB need a tree, so they do nothing here (use
+// Match() for grammars that have them). An ignored match that has no tail after all leaves what is inside it unvisited, where
+// Match() would keep it. Returns false if the content nests deeper than QENTEM_MAX_DEPTH; visiting stops there.
+static bool Visit(const Expressions &expres, const char *content, UNumber offset, const UNumber limit, VisitCB_ *visit,
+                  void *other = nullptr) noexcept {
+    const UNumber      maxOffset = (offset + limit);
+    UNumber            endOffset = maxOffset;
+    const Expressions *exps      = &expres;
+    const Expression * expr      = nullptr;
+    Array<VisitFrame>  frames;
+    TailCache          tails;
+    MatchBit           item;
+    UNumber            current_offset = 0;
+    UNumber            sub_offset     = 0;
+    UNumber            tail_end       = 0;
+    UNumber            last_end       = 0;
+    UNumber            nest_end       = 0;
+    UNumber            hidden         = 0; // The ignored matches that the level is inside.
+    UShort             expr_id        = 0;
+    UShort             keyword_offset;
+    bool               resumed = false; // Back from a nested level, to the tail search of expr.
+    bool               nesting = false; // A nested level is next.
+
+    for (;;) {
+        if (exps->Compiled != exps->Size) {
+            exps->Compile();
+        }
+
+        while (offset < endOffset) {
+            if (!resumed) {
+                if (expr_id == 0) {
+                    offset = findLead(*exps, content, offset, endOffset);
+
+                    if (offset == endOffset) {
+                        current_offset = (offset - 1);
+                        break;
+                    }
+
+                    expr_id = static_cast<UShort>(exps->Leads[static_cast<unsigned char>(content[offset])] - 1);
+                }
+
+                current_offset = offset;
+                expr           = (*exps)[expr_id];
+                keyword_offset = 0;
+
+                while ((keyword_offset < expr->HLength) && (expr->Head[keyword_offset] == content[current_offset])) {
+                    ++current_offset;
+                    ++keyword_offset;
+                }
+
+                if ((keyword_offset == 0) || (keyword_offset != expr->HLength)) {
+                    if (exps->Size == (++expr_id)) {
+                        expr_id = 0;
+                        ++offset;
+                    }
+                    continue;
+                }
+
+                sub_offset = current_offset;
+                nest_end   = 0;
+            }
+
+            if (expr->TLength != 0) {
+                keyword_offset = 0;
+
+                for (;;) {
+                    if (resumed) {
+                        resumed = false;
+                    } else {
+                        tail_end = findTail(tails, expr, content, current_offset, maxOffset);
+
+                        if (tail_end == 0) {
+                            break;
+                        }
+
+                        if ((expr->NestExpres.Size != 0) && ((sub_offset + expr->TLength) != tail_end)) {
+                            if (frames.Size == QENTEM_MAX_DEPTH) {
+                                return false;
+                            }
+
+                            if (sub_offset == (offset + expr->HLength)) {
+                                // The first time it goes in.
+                                if ((Flags::IGNORE & expr->Flag) != 0) {
+                                    ++hidden;
+                                } else if (hidden == 0) {
+                                    item.Offset = offset;
+                                    item.Length = 0;
+                                    item.Expr   = expr;
+                                    visit(content, item, Events::ENTER, other);
+                                }
+                            }
+
+                            if (frames.Size == frames.Capacity) {
+                                frames.Resize((frames.Capacity < 16) ? 16 : (frames.Capacity * 2));
+                            }
+
+                            VisitFrame *frame = &(frames[frames.Size++]);
+                            frame->Expres     = exps;
+                            frame->Expr       = expr;
+                            frame->Offset     = offset;
+                            frame->EndOffset  = endOffset;
+                            frame->TailEnd    = tail_end;
+                            frame->LastEnd    = last_end;
+                            frame->NestEnd    = nest_end;
+                            frame->ExprID     = expr_id;
+
+                            exps      = &(expr->NestExpres);
+                            offset    = sub_offset;
+                            endOffset = tail_end;
+                            last_end  = 0;
+                            expr_id   = 0;
+                            nesting   = true;
+                            break;
+                        }
+                    }
+
+                    if (tail_end > sub_offset) {
+                        current_offset = tail_end;
+                        keyword_offset = 1; // Found.
+                        break;
+                    }
+
+                    current_offset = sub_offset;
+                }
+
+                if (nesting) {
+                    break;
+                }
+
+                if (keyword_offset == 0) {
+                    const bool entered = (nest_end != 0) || (sub_offset != (offset + expr->HLength));
 
-    return items;
+                    if ((Flags::IGNORE & expr->Flag) != 0) {
+                        if (entered) {
+                            --hidden;
+                        }
+                    } else if (entered && (hidden == 0)) {
+                        item.Offset = offset;
+                        item.Length = 0;
+                        item.Expr   = expr;
+                        visit(content, item, Events::LEAVE, other);
+                    }
+
+                    current_offset = maxOffset;
+
+                    if (nest_end != 0) {
+                        // What has been visited inside it stays.
+                        last_end = nest_end;
+                        offset   = nest_end;
+                        expr_id  = 0;
+                    } else if (exps->Size == (++expr_id)) {
+                        expr_id = 0;
+                        ++offset;
+                    }
+
+                    continue;
+                }
+            }
+
+            const bool entered = (nest_end != 0) || (sub_offset != (offset + expr->HLength));
+
+            if ((Flags::IGNORE & expr->Flag) == 0) {
+                if (hidden == 0) {
+                    item.Offset = offset;
+                    item.Length = (current_offset - offset);
+                    item.Expr   = expr;
+                    visit(content, item, (entered ? Events::LEAVE : Events::MATCH), other);
+                }
+
+                last_end = current_offset;
+
+                if ((Flags::ONCE & expr->Flag) != 0) {
+                    break;
+                }
+            } else if (entered) {
+                --hidden;
+            }
+
+            expr_id = 0;
+            offset  = current_offset;
+        }
+
+        if (nesting) {
+            nesting = false;
+            continue;
+        }
+
+        if (frames.Size == 0) {
+            return true;
+        }
+
+        // Back to the level that it is nested in.
+        const VisitFrame *frame = &(frames[--frames.Size]);
+        sub_offset              = current_offset;
+        nest_end                = ((last_end != 0) ? last_end : frame->NestEnd);
+        exps                    = frame->Expres;
+        expr                    = frame->Expr;
+        offset                  = frame->Offset;
+        endOffset               = frame->EndOffset;
+        tail_end                = frame->TailEnd;
+        last_end                = frame->LastEnd;
+        expr_id                 = frame->ExprID;
+        resumed                 = true;
+    }
 }
 /////////////////////////////////
-static void split(Array<MatchBit> &items, const char *content, UNumber offset, const UNumber endOffset, const UNumber count) noexcept {
-    const UNumber started  = offset;
-    MatchBit *    item_ptr = nullptr;
+// Replaces the items of a level (tree.Stack[level, ...]) with the pieces between its split matches; the rest of the items
+// go inside the pieces that hold them.
+template <typename Tree>
+static void split(Tree &tree, const UNumber level, const char *content, UNumber offset, const UNumber endOffset,
+                  const UNumber count) noexcept {
+    const UNumber      started    = offset;
+    const UNumber      end_level  = tree.Stack.Size;
+    UNumber            nest_start = level;
+    UNumber            mark;
+    UNumber            piece_offset;
+    UNumber            piece_length;
+    const Expression * expr = nullptr; // The last split match.
+    typename Tree::Bit item;
+
+    // The pieces before the first split match take its flags.
+    for (UNumber i = level; (expr == nullptr) && (i < end_level); i++) {
+        if ((Flags::SPLIT & tree.ExprOf(tree.Stack[i])->Flag) != 0) {
+            expr = tree.ExprOf(tree.Stack[i]);
+        }
+    }
+
+    if (expr == nullptr) {
+        return;
+    }
 
-    Array<MatchBit> splitted(count + 1);
-    MatchBit        item;
+    if (tree.Stack.Capacity < (end_level + count + 1)) {
+        tree.Stack.Resize(end_level + count + 1);
+    }
+
+    for (UNumber i = level; i <= end_level; i++) {
+        piece_offset = offset;
 
-    for (UNumber i = 0; i <= items.Size; i++) {
-        if (i != items.Size) {
-            item_ptr = &(items[i]);
+        if (i != end_level) {
+            const typename Tree::Bit *item_ptr = &(tree.Stack[i]);
 
-            if ((Flags::SPLIT & item_ptr->Expr->Flag) == 0) {
-                item.NestMatch += static_cast<MatchBit &&>(*item_ptr);
+            if ((Flags::SPLIT & tree.ExprOf(*item_ptr)->Flag) == 0) {
                 continue;
             }
 
-            item.Offset = offset;
-            item.Length = item_ptr->Offset - offset;
-            item.Expr   = item_ptr->Expr;
+            expr         = tree.ExprOf(*item_ptr);
+            piece_length = (item_ptr->Offset - offset);
 
-            offset += item.Length + item_ptr->Length;
+            offset += piece_length + item_ptr->Length;
         } else {
-            item.Offset = offset;
-            item.Length = endOffset - offset;
+            piece_length = (endOffset - offset);
         }
 
-        if ((Flags::TRIM & item.Expr->Flag) != 0) {
-            String::SoftTrim(content, item.Offset, item.Length);
+        if ((Flags::TRIM & expr->Flag) != 0) {
+            String::SoftTrim(content, piece_offset, piece_length);
         }
 
-        if (((Flags::DROPEMPTY & item.Expr->Flag) == 0) || (item.Length != 0)) {
-            if (item.Expr->NestExpres.Size != 0) {
-                item.NestMatch = Match(item.Expr->NestExpres, content, item.Offset, item.Length);
+        if (((Flags::DROPEMPTY & expr->Flag) == 0) || (piece_length != 0)) {
+            tree.Set(item, piece_offset, piece_length, expr);
+
+            if (expr->NestExpres.Size != 0) {
+                mark = tree.Stack.Size;
+                matchAll(tree, expr->NestExpres, content, piece_offset, (piece_offset + piece_length));
+                tree.Nest(item, mark, tree.Stack.Size);
+                tree.Stack.Size = mark;
+            } else {
+                tree.Nest(item, nest_start, i);
             }
 
-            splitted += static_cast<MatchBit &&>(item);
+            // The pieces go after the items of the level, for now.
+            tree.Stack += item;
         }
+
+        nest_start = (i + 1);
     }
 
-    if ((Flags::GROUPED & item.Expr->Flag) == 0) {
-        items = static_cast<Array<MatchBit> &&>(splitted);
-    } else {
-        items.SetCapacity(1);
-        ++items.Size;
+    // Moving the pieces in place of the items.
+    mark = level;
+
+    for (UNumber i = end_level; i < tree.Stack.Size; i++) {
+        tree.Stack[mark++] = tree.Stack[i];
+    }
+
+    tree.Stack.Size = mark;
+
+    if ((Flags::GROUPED & expr->Flag) != 0) {
+        tree.Set(item, started, (endOffset - started), expr);
+        tree.Nest(item, level, tree.Stack.Size);
+        tree.Stack.Size = level;
+        tree.Stack += item;
+    }
+}
+/////////////////////////////////
+// Matches content that comes in chunks. Only what is not done yet is kept: the part that the last call handed out, and the rest
+// of the content from the head of the first top level match that has not closed yet.
+struct MatchStream {
+    const Expressions *Expres;
+    String             Content{}; // The matches of the last call point into it; then comes the part that waits for more.
+    UNumber            Done{0};   // Where the matches of the last call end in Content.
+    UNumber            Base{0};   // The offset of Content[0] in the whole stream.
+    UNumber            Waited{0}; // How much content was waiting when the last call ran out of it.
+    MatchTree          Matches{};
+
+    explicit MatchStream(const Expressions &expres) noexcept : Expres(&expres) {
+    }
+
+    // Adds a chunk, and returns the top level matches that it has closed. Content is valid until the next call, and everything
+    // before Done in it is final; e.g. Parse(matches, stream.Content.Str, 0, stream.Done).
+    const MatchTree &Feed(const char *chunk, const UNumber length) noexcept {
+        drop();
+
+        if (length != 0) {
+            if ((Content.Length + length) > Content.Capacity) {
+                UNumber capacity = (Content.Capacity * 2);
+
+                if (capacity < (Content.Length + length)) {
+                    capacity = (Content.Length + length);
+                }
+
+                String tmp(capacity);
+                String::Appand(tmp, Content.Str, 0, Content.Length);
+                Content = static_cast<String &&>(tmp);
+            }
 
-        item_ptr = &(items[0]);
+            String::Appand(Content, chunk, Content.Length, length);
+        }
+
+        return scan(false);
+    }
+
+    // The end of the stream: matches whatever is left, the way Match() does.
+    const MatchTree &Finish() noexcept {
+        drop();
+        return scan(true);
+    }
+
+    // Drops what the last call has handed out.
+    void drop() noexcept {
+        if (Done != 0) {
+            Base += Done;
+            Content.Length -= Done;
 
-        item_ptr->Offset = started;
-        item_ptr->Length = (endOffset - started);
-        // item_ptr->NestMatch          = static_cast<Array<MatchBit> &&>(splitted);
-        item_ptr->NestMatch.Size     = splitted.Size;
-        item_ptr->NestMatch.Storage  = splitted.Storage;
-        item_ptr->NestMatch.Capacity = splitted.Capacity;
-        splitted.Storage             = nullptr;
-        item_ptr->Expr               = item.Expr;
+            Memory::Move(Content.Str, (Content.Str + Done), Content.Length);
+            Content[Content.Length] = '\0';
+            Done                    = 0;
+        }
+    }
+
+    const MatchTree &scan(const bool last) noexcept {
+        const Expressions &expres      = *Expres;
+        UNumber            split_count = 0;
+
+        Matches.Reset();
+
+        if (!last) {
+            // Splitting and popping need the whole content; a long match is tried again once the waiting part has doubled.
+            if ((expres.Size == 0) || ((Flags::POP & expres[0]->Flag) != 0) || (Content.Length < (Waited * 2))) {
+                return Matches;
+            }
+
+            for (UNumber i = 0; i < expres.Size; i++) {
+                if ((Flags::SPLIT & expres[i]->Flag) != 0) {
+                    return Matches;
+                }
+            }
+
+            Matches.StreamEnd = Content.Length;
+            Matches.Starved   = false;
+        }
+
+        if (Content.Length != 0) {
+            match(Matches, 0, expres, Content.Str, 0, Content.Length, Content.Length, split_count);
+        }
+
+        if (Matches.TooDeep) {
+            // Nothing matches; the content is handed out as it is.
+            Matches.Stack.Size = 0;
+            Done               = Content.Length;
+            Waited             = 0;
+        } else if (Matches.Starved) {
+            Done   = Matches.Resume;
+            Waited = (Content.Length - Done);
+        } else {
+            Done   = Content.Length;
+            Waited = 0;
+
+            if (split_count != 0) {
+                split(Matches, 0, Content.Str, 0, Content.Length, split_count);
+            }
+        }
+
+        Matches.StreamEnd = 0;
+        Matches.Starved   = false;
+        Matches.Close();
+
+        return Matches;
+    }
+};
+/////////////////////////////////
+// Renders one match: its replacement, or what its callback gives.
+static void parseItem(Sink &sink, const MatchBit &item, const char *content, void *other) noexcept {
+    const Expression *expr = item.Expr;
+
+    if ((expr->ParseToCB == nullptr) && (expr->ParseCB == nullptr)) {
+        // Defaults to replace: it can be empty.
+        sink.Add(expr->ReplaceWith, expr->RLength);
+    } else if ((Flags::BUBBLE & expr->Flag) == 0) {
+        if (expr->ParseToCB != nullptr) {
+            expr->ParseToCB(sink, content, item, item.Length, other);
+        } else {
+            sink += expr->ParseCB(content, item, item.Length, other);
+        }
+    } else if (item.NestMatch.Size != 0) {
+        Sink tmp(item.Length);
+        ParseTo(tmp, item.NestMatch, content, item.Offset, item.Length, other);
+
+        if (expr->ParseToCB != nullptr) {
+            expr->ParseToCB(sink, tmp.Str, item, tmp.Length, other);
+        } else {
+            sink += expr->ParseCB(tmp.Str, item, tmp.Length, other);
+        }
+    } else if (expr->ParseToCB != nullptr) {
+        expr->ParseToCB(sink, &(content[item.Offset]), item, item.Length, other);
+    } else {
+        sink += expr->ParseCB(String::Part(content, item.Offset, item.Length).Str, item, item.Length, other);
     }
 }
 /////////////////////////////////
-static String Parse(const Array<MatchBit> &items, const char *content, UNumber offset, UNumber limit, void *other = nullptr) noexcept {
-    StringStream    rendered; // Final content
+// Renders content into a sink, with the result of Match() on it.
+static void ParseTo(Sink &sink, const MatchList &items, const char *content, UNumber offset, UNumber limit, void *other) noexcept {
     UNumber         tmp_limit;
     const MatchBit *item;
 
@@ -275,33 +1560,75 @@ static String Parse(const Array<MatchBit> &items, const char *content, UNumber o
             tmp_limit = (item->Offset - offset);
 
             if (tmp_limit >= limit) {
-                // If it's equal, then String::Part outside this loop will handel it.
+                // If it's equal, then the Add() outside this loop will handel it.
                 break;
             }
 
             limit -= tmp_limit;
-            rendered += String::Part(content, offset, tmp_limit);
+            sink.Add(&(content[offset]), tmp_limit);
         }
 
         offset = item->Offset + item->Length;
         limit -= item->Length;
 
-        if (item->Expr->ParseCB == nullptr) {
-            // Defaults to replace: it can be empty.
-            rendered.Add(item->Expr->RLength, item->Expr->ReplaceWith);
-        } else if ((Flags::BUBBLE & item->Expr->Flag) == 0) {
-            rendered += item->Expr->ParseCB(content, *item, item->Length, other);
-        } else if (item->NestMatch.Size != 0) {
-            String tmp_string(Parse(item->NestMatch, content, item->Offset, item->Length, other));
-            rendered += item->Expr->ParseCB(tmp_string.Str, *item, tmp_string.Length, other);
-        } else {
-            rendered += item->Expr->ParseCB(String::Part(content, item->Offset, item->Length).Str, *item, item->Length, other);
-        }
+        parseItem(sink, *item, content, other);
     }
 
     if (limit != 0) {
-        rendered += String::Part(content, offset, limit);
+        sink.Add(&(content[offset]), limit);
+    }
+}
+/////////////////////////////////
+// For ParseTo() on Visit().
+struct VisitParse {
+    Sink *  Out{nullptr};
+    void *  Other{nullptr};
+    UNumber Offset{0}; // Where the content has been rendered to.
+    UNumber Depth{0};
+};
+
+static void parseVisited(const char *content, const MatchBit &item, const UShort event, void *other) noexcept {
+    VisitParse *state = static_cast<VisitParse *>(other);
+
+    if (event == Events::ENTER) {
+        ++(state->Depth);
+        return;
+    }
+
+    if (event == Events::LEAVE) {
+        --(state->Depth);
+
+        if (item.Length == 0) {
+            return;
+        }
+    }
+
+    if (state->Depth == 0) {
+        state->Out->Add(&(content[state->Offset]), (item.Offset - state->Offset));
+        state->Offset = (item.Offset + item.Length);
+
+        parseItem(*(state->Out), item, content, state->Other);
     }
+}
+
+// Matches and renders in one pass, without a tree: the top level matches are rendered as ParseTo() does, but BUBBLE has no
+// sub matches to parse, and the grammar is limited as in Visit().
+static void ParseTo(Sink &sink, const Expressions &expres, const char *content, const UNumber offset, const UNumber limit,
+                    void *other = nullptr) noexcept {
+    VisitParse state;
+    state.Out    = &sink;
+    state.Other  = other;
+    state.Offset = offset;
+
+    Visit(expres, content, offset, limit, &(parseVisited), &state);
+
+    sink.Add(&(content[state.Offset]), ((offset + limit) - state.Offset));
+}
+/////////////////////////////////
+inline static String Parse(const MatchList &items, const char *content, const UNumber offset, const UNumber limit,
+                           void *other = nullptr) noexcept {
+    Sink rendered(limit);
+    ParseTo(rendered, items, content, offset, limit, other);
 
     return rendered.ToString();
 }
@@ -20,11 +20,15 @@ using Engine::Expression;
 using Engine::Expressions;
 using Engine::Flags;
 using Engine::MatchBit;
+using Engine::MatchList;
+using Engine::MatchTree;
 
-static bool   Process(double &number, const Array<MatchBit> &items, const char *content, UNumber offset, UNumber limit) noexcept;
+static bool   Process(double &number, const MatchList &items, const char *content, UNumber offset, UNumber limit) noexcept;
 static double Evaluate(const char *content, UNumber offset, UNumber limit) noexcept;
 
 static const Expressions &getMathExpres() noexcept {
+    const Memory::AllocatorScope global(nullptr);
+
     static constexpr UNumber flags_no_pop = Flags::SPLIT | Flags::TRIM;
     static constexpr UNumber flags_pop    = flags_no_pop | Flags::POP;
 
@@ -137,7 +141,7 @@ static const Expressions &getMathExpres() noexcept {
     return expres;
 }
 
-static double Multiply(const char *content, const Array<MatchBit> &items) noexcept {
+static double Multiply(const char *content, const MatchList &items) noexcept {
     const MatchBit *mb    = &(items[0]);
     UShort          op_id = mb->Expr->ID;
     double          number1;
@@ -202,7 +206,7 @@ static double Multiply(const char *content, const Array<MatchBit> &items) noexce
     return number1;
 }
 
-static double Add(const char *content, const Array<MatchBit> &items) noexcept {
+static double Add(const char *content, const MatchList &items) noexcept {
     const MatchBit *mb      = &(items[0]);
     UShort          op_id   = mb->Expr->ID;
     double          number1 = 0.0;
@@ -240,7 +244,7 @@ static double Add(const char *content, const Array<MatchBit> &items) noexcept {
     return number1;
 }
 
-static double Equal(const char *content, const Array<MatchBit> &items) noexcept {
+static double Equal(const char *content, const MatchList &items) noexcept {
     double number1 = 0.0;
     double number2;
 
@@ -298,7 +302,7 @@ static double Equal(const char *content, const Array<MatchBit> &items) noexcept
     return number1;
 }
 
-static double LogicAnd(const char *content, const Array<MatchBit> &items) noexcept {
+static double LogicAnd(const char *content, const MatchList &items) noexcept {
     const MatchBit *mb    = &(items[0]);
     UShort          op_id = mb->Expr->ID;
     double          number1;
@@ -332,7 +336,7 @@ static double LogicAnd(const char *content, const Array<MatchBit> &items) noexce
     return number1;
 }
 
-static bool Process(double &number, const Array<MatchBit> &items, const char *content, const UNumber offset, const UNumber limit) noexcept {
+static bool Process(double &number, const MatchList &items, const char *content, const UNumber offset, const UNumber limit) noexcept {
     if (items.Size == 0) {
         if (content[offset] == '(') {
             if (limit < 3) {
@@ -390,7 +394,7 @@ static double Evaluate(const char *content, UNumber offset, UNumber limit) noexc
      */
     double num;
 
-    Array<MatchBit> items(Engine::Match(getMathExpres(), content, offset, limit));
+    const MatchTree items(Engine::Match(getMathExpres(), content, offset, limit));
 
     if (items.Size == 0) {
         String::SoftTrim(content, offset, limit);
@@ -9,6 +9,7 @@
  */
 
 #include "Engine.hpp"
+#include "JSON.hpp"
 
 #ifndef QENTEM_DOCUMENT_H
 #define QENTEM_DOCUMENT_H
@@ -18,13 +19,48 @@ namespace Qentem {
 using Engine::Expression;
 using Engine::Expressions;
 using Engine::MatchBit;
+using Engine::MatchList;
+using Engine::MatchTree;
+
+struct Index;
+struct Entry;
+struct Document;
+struct JSONSource;
+
+namespace Memory {
+template <>
+struct Relocatable<Index> {
+    static const bool Value = true;
+};
+
+// The tables, the entries and the documents inside; keys, strings and numbers count as strings and arrays.
+template <>
+struct KindOf<Index> {
+    static const Kind Value = DocumentK;
+};
+
+template <>
+struct KindOf<Entry> {
+    static const Kind Value = DocumentK;
+};
+
+template <>
+struct KindOf<Document> {
+    static const Kind Value = DocumentK;
+};
+
+template <>
+struct KindOf<JSONSource> {
+    static const Kind Value = DocumentK;
+};
+} // namespace Memory
 
 enum VType { UndefinedT = 0, NumberT = 1, StringT = 2, DocumentT = 3, FalseT = 4, TrueT = 5, NullT = 6 };
 
+// A slot of the hash table of an object; a hash of 0 marks an empty one.
 struct Index {
-    UNumber      Hash{0};
-    UNumber      EntryID{0};
-    Array<Index> Table{};
+    UNumber Hash{0};
+    UNumber EntryID{0};
 
     Index() = default;
 
@@ -38,6 +74,81 @@ struct Entry {
     UNumber ArrayID;
 };
 
+// What Document::FromJSON() has built so far, from the events of JSON::Read().
+struct JSONBuilder {
+    Array<Document>   Docs{}; // The open objects and arrays; the last one is the one that the text is in.
+    Array<StringView> Keys{}; // The key of the value that comes next in each of them; Str is nullptr if there is none.
+    Document *        Result;
+};
+
+// The JSON text of Document::FromJSONLazy(), that the documents which have not been parsed yet share; the last one frees it.
+struct JSONSource {
+    String         Content{};
+    Array<UNumber> Structurals{}; // JSON::Index() of Content.
+    Array<UNumber> Closes{};      // For every { and [ in Structurals, where its closing bracket is in it.
+    UNumber        Count{0};      // The parts that point into it; not atomic.
+};
+
+// The part of a JSONSource that a document has not been parsed from yet: the structural bytes from its opening bracket (At) to
+// its closing one. Copies share the source.
+struct JSONPart {
+    JSONSource *Source{nullptr};
+    UNumber     At{0};
+
+    JSONPart() = default;
+
+    JSONPart(JSONSource *source, const UNumber at) noexcept : Source(source), At(at) {
+        ++(Source->Count);
+    }
+
+    JSONPart(JSONPart &&src) noexcept : Source(src.Source), At(src.At) {
+        src.Source = nullptr;
+    }
+
+    JSONPart(const JSONPart &src) noexcept : Source(src.Source), At(src.At) {
+        if (Source != nullptr) {
+            ++(Source->Count);
+        }
+    }
+
+    JSONPart &operator=(JSONPart &&src) noexcept {
+        if (this != &src) {
+            Release();
+            Source     = src.Source;
+            At         = src.At;
+            src.Source = nullptr;
+        }
+
+        return *this;
+    }
+
+    JSONPart &operator=(const JSONPart &src) noexcept {
+        if (this != &src) {
+            Release();
+            Source = src.Source;
+            At     = src.At;
+
+            if (Source != nullptr) {
+                ++(Source->Count);
+            }
+        }
+
+        return *this;
+    }
+
+    ~JSONPart() noexcept {
+        Release();
+    }
+
+    void Release() noexcept {
+        if ((Source != nullptr) && (--(Source->Count) == 0)) {
+            Memory::DeallocateBit<JSONSource>(&Source);
+        }
+
+        Source = nullptr;
+    }
+};
+
 struct {
     const char *fss1   = "{";
     const char *fss2   = "}";
@@ -54,9 +165,8 @@ struct {
 struct Document {
     bool Ordered = false;
 
-    UNumber       HashBase{17}; // Or 97; a prime number only!
     Array<String> Keys;
-    Array<Index>  Table;
+    Array<Index>  Table; // Open addressing, Robin Hood: its size is a power of two, and at most 3/4 of it is taken.
     Array<Entry>  Entries;
 
     Array<double>   Numbers;
@@ -66,6 +176,8 @@ struct Document {
     UNumber     LastKeyLen{0};
     const char *LastKey{nullptr};
 
+    JSONPart Lazy{}; // What a document of FromJSONLazy() has not been parsed from yet; Load() parses it.
+
     static constexpr const char *char_list = R"({[]}\\")";
 
     Document()                    = default;
@@ -141,11 +253,7 @@ struct Document {
 
     Document(const char *value) noexcept {
         if (value != nullptr) {
-            const Array<MatchBit> items(Engine::Match(getJsonExpres(), value, 0, String::Count(value)));
-
-            if (items.Size != 0) {
-                *this = makeList(items[0].NestMatch, value, items[0].Offset, items[0].Length);
-            } else {
+            if (!parseJSON(*this, value, 0, String::Count(value))) {
                 // Just a string.
                 Ordered = true;
                 Strings += value;
@@ -158,11 +266,7 @@ struct Document {
     }
 
     Document(const String &value) noexcept {
-        const Array<MatchBit> items(Engine::Match(getJsonExpres(), value.Str, 0, value.Length));
-
-        if (items.Size != 0) {
-            *this = makeList(items[0].NestMatch, value.Str, items[0].Offset, items[0].Length);
-        } else {
+        if (!parseJSON(*this, value.Str, 0, value.Length)) {
             Ordered = true;
             Strings += value;
             Entries += {VType::StringT, 0, 0};
@@ -170,11 +274,7 @@ struct Document {
     }
 
     Document(String &&value) noexcept {
-        const Array<MatchBit> items(Engine::Match(getJsonExpres(), value.Str, 0, value.Length));
-
-        if (items.Size != 0) {
-            *this = makeList(items[0].NestMatch, value.Str, items[0].Offset, items[0].Length);
-        } else {
+        if (!parseJSON(*this, value.Str, 0, value.Length)) {
             Ordered = true;
             Strings += static_cast<String &&>(value);
             Entries += {VType::StringT, 0, 0};
@@ -188,11 +288,28 @@ struct Document {
         Numbers.Reset();
         Strings.Reset();
         Documents.Reset();
+        Lazy.Release();
 
         LastKey    = nullptr;
         LastKeyLen = 0;
     }
 
+    // Parses a document that FromJSONLazy() has left for later. Whatever looks into a document calls it first, and gets the
+    // documents inside it with child(), so the ones that nothing looks into are never parsed.
+    void Load() const noexcept {
+        if (Lazy.Source != nullptr) {
+            // It fills Entries, Keys and Table, through const, with what FromJSON() would have put in them.
+            const_cast<Document *>(this)->loadJSON();
+        }
+    }
+
+    Document &child(const UNumber id) const noexcept {
+        Document &doc = Documents[id];
+        doc.Load();
+
+        return doc;
+    }
+
     static void Delete(Entry &entry, const Document &storage) noexcept {
         entry.Type = VType::UndefinedT;
 
@@ -216,6 +333,8 @@ struct Document {
     }
 
     void Delete(const UNumber id) noexcept {
+        Load();
+
         if (id < Entries.Size) {
             Delete(Entries[id], *this);
         }
@@ -230,40 +349,90 @@ struct Document {
         }
     }
 
-    static void InsertIndex(const Index &index, const UNumber hashBase, const UNumber level, Array<Index> &table) noexcept {
-        const UNumber id = ((index.Hash + level) % hashBase);
+    // Puts index in the first empty slot from its own on, and takes the slots of the ones that are closer to theirs (Robin Hood),
+    // so no key is far from its slot. The table must have an empty slot.
+    static void InsertIndex(Index index, Array<Index> &table) noexcept {
+        const UNumber mask     = (table.Size - 1);
+        UNumber       id       = (index.Hash & mask);
+        UNumber       distance = 0;
 
-        if (table.Capacity <= id) {
-            table.Resize(id + 1);
-            table.Size = table.Capacity;
-            table[id]  = index;
-        } else if (table[id].Hash == 0) {
-            table[id] = index;
-        } else {
-            InsertIndex(index, hashBase, (level + 1), table[id].Table);
+        while (table[id].Hash != 0) {
+            const UNumber other = ((id - table[id].Hash) & mask); // How far that one is from its slot.
+
+            if (other < distance) {
+                const Index tmp = table[id];
+                table[id]       = index;
+                index           = tmp;
+                distance        = other;
+            }
+
+            id = ((id + 1) & mask);
+            ++distance;
         }
+
+        table[id] = index;
     }
 
-    Entry *Exist(UNumber hash, const UNumber level, const Array<Index> &table) const noexcept {
-        const UNumber id = ((hash + level) % HashBase);
+    // Makes a table of size slots, a power of two, and puts the indexes of the old one in it.
+    void resizeTable(const UNumber size) noexcept {
+        Array<Index> old(static_cast<Array<Index> &&>(Table));
+        Table.Expand(size);
 
-        if ((table.Size > id) && (table[id].Hash != 0)) {
-            if (table[id].Hash == hash) {
-                return &(Entries[table[id].EntryID]);
+        for (UNumber i = 0; i < old.Size; i++) {
+            if (old[i].Hash != 0) {
+                InsertIndex(old[i], Table);
             }
+        }
+    }
 
-            return Exist(hash, (level + 1), table[id].Table);
+    // Adds the index of the next entry, and doubles the table when it would be more than 3/4 full.
+    void addIndex(const UNumber hash) noexcept {
+        if (((Entries.Size + 1) * 4) > (Table.Size * 3)) {
+            resizeTable((Table.Size != 0) ? (Table.Size * 2) : 8);
+        }
+
+        InsertIndex({hash, Entries.Size}, Table);
+    }
+
+    // The entry of key; its hash is only a hint, so the key itself has to match too. The search stops at an empty slot, or at
+    // one that is closer to its own slot than key would be, as key would have taken it.
+    Entry *Exist(const StringView &key, const UNumber hash) const noexcept {
+        if (Table.Size != 0) {
+            const UNumber mask     = (Table.Size - 1);
+            UNumber       id       = (hash & mask);
+            UNumber       distance = 0;
+
+            while ((Table[id].Hash != 0) && (((id - Table[id].Hash) & mask) >= distance)) {
+                if (Table[id].Hash == hash) {
+                    Entry *entry = &(Entries[Table[id].EntryID]);
+
+                    if (Keys[entry->KeyID] == key) {
+                        return entry;
+                    }
+                }
+
+                id = ((id + 1) & mask);
+                ++distance;
+            }
         }
 
         return nullptr;
     }
 
-    void Rehash(const UNumber newBase, const bool children = false) noexcept {
+    // Builds the table again from the keys, with room for at least size of them without growing; deleted keys drop out of it.
+    void Rehash(const UNumber size, const bool children = false) noexcept {
+        Load();
+
         if (!Ordered) {
+            UNumber slots = 8;
+
+            while ((slots * 3) < (((size > Entries.Size) ? size : Entries.Size) * 4)) {
+                slots <<= 1U;
+            }
+
             Table.Reset();
-            HashBase = newBase;
+            Table.Expand(slots);
 
-            Index         index;
             const String *key;
             const Entry * entry;
 
@@ -271,14 +440,11 @@ struct Document {
                 entry = &(Entries[i]);
 
                 if (entry->Type != VType::UndefinedT) {
-                    key           = &(Keys[entry->KeyID]);
-                    index.Hash    = String::Hash(key->Str, 0, key->Length);
-                    index.EntryID = i;
-
-                    InsertIndex(index, HashBase, 0, Table);
+                    key = &(Keys[entry->KeyID]);
+                    InsertIndex({String::Hash(key->Str, 0, key->Length), i}, Table);
 
                     if (children && (entry->Type == VType::DocumentT)) {
-                        Documents[entry->ArrayID].Rehash(HashBase, true);
+                        child(entry->ArrayID).Rehash(size, true);
                     }
                 }
             }
@@ -291,8 +457,7 @@ struct Document {
 
             UNumber nid = Entries.Size;
 
-            Entries.Resize(entryID + 1);
-            Entries.Size = Entries.Capacity;
+            Entries.Expand(entryID + 1);
 
             while (nid < entryID) {
                 Insert(nid++, type, ptr, false);
@@ -376,7 +541,7 @@ struct Document {
     }
 
     void InsertHash(UNumber id, const char *key, const UNumber offset, const UNumber limit, const VType type) noexcept {
-        InsertIndex({String::Hash(key, offset, limit), Entries.Size}, HashBase, 0, Table);
+        addIndex(String::Hash(key, offset, limit));
         Entries += {type, Keys.Size, id};
         Keys += String::Part(key, offset, limit);
     }
@@ -384,7 +549,7 @@ struct Document {
     UNumber Insert(const char *key, const UNumber offset, const UNumber limit, const VType type, void *ptr, const bool move) noexcept {
         UNumber       id    = 0;
         const UNumber hash  = String::Hash(key, offset, limit);
-        Entry *       entry = Exist(hash, 0, Table);
+        Entry *       entry = Exist(StringView(key, offset, limit), hash);
 
         if ((entry == nullptr) || (entry->Type != type)) {
             // New item.
@@ -466,233 +631,317 @@ struct Document {
             return id;
         }
 
-        InsertIndex({hash, Entries.Size}, HashBase, 0, Table);
+        addIndex(hash);
         Entries += {type, Keys.Size, id};
         Keys += String::Part(key, offset, limit);
 
         return id;
     }
 
-    static Document makeList(Array<MatchBit> &items, const char *content, const UNumber offset, const UNumber length) noexcept {
-        Document  document;
-        MatchBit *item;
-        UNumber   x;
+    // The string between two quotes; \\ and \" stand for \ and ", and the other escapes stay as they are.
+    static String jsonString(const char *content, const UNumber offset, const UNumber length) noexcept {
+        const char *str = (content + offset);
+        const char *end = (str + length);
+        const char *esc = static_cast<const char *>(std::memchr(str, '\\', length));
 
-        bool          done           = false;
-        UNumber       item_id        = 0;
-        UNumber       current_offset = (offset + 1);
-        const UNumber end            = (length + offset);
+        if (esc == nullptr) {
+            return String(str, length);
+        }
 
-        if (content[offset] == '{') {
-            while (item_id < items.Size) {
-                item = &(items[item_id++]);
-                x    = (item->Offset + item->Length);
+        String        value(length);
+        const UNumber plain = static_cast<UNumber>(esc - str);
+        char *        to    = (value.Str + plain);
 
-                for (; x < end; x++) {
-                    while (content[x] == ' ') {
-                        ++x;
-                    }
+        Memory::Copy(value.Str, str, plain);
+        str = esc;
 
-                    switch (content[x]) {
-                        case ',':
-                        case '}': {
-                            // A true, false, null or number value.
-                            UNumber limit = x - current_offset;
-                            String::SoftTrim(content, current_offset, limit);
-
-                            switch (content[current_offset]) {
-                                case 'f': {
-                                    // False
-                                    document.InsertHash(0, content, (item->Offset + 1), (item->Length - 2), VType::FalseT);
-                                    break;
-                                }
-                                case 't': {
-                                    // True
-                                    document.InsertHash(0, content, (item->Offset + 1), (item->Length - 2), VType::TrueT);
-                                    break;
-                                }
-                                case 'n': {
-                                    // Null
-                                    document.InsertHash(0, content, (item->Offset + 1), (item->Length - 2), VType::NullT);
-                                    break;
-                                }
-                                default: {
-                                    double number;
-                                    if (String::ToNumber(number, content, current_offset, limit)) {
-                                        // Number
-                                        document.InsertHash(document.Numbers.Size, content, (item->Offset + 1), (item->Length - 2),
-                                                            VType::NumberT);
-                                        document.Numbers += number;
-                                    }
-                                    break;
-                                }
-                            }
+        while (str != end) {
+            if ((*str == '\\') && ((str + 1) != end) && ((str[1] == '\\') || (str[1] == '"'))) {
+                ++str;
+            }
 
-                            done = true;
-                            break;
-                        }
-                        case '"': {
-                            document.InsertHash(document.Strings.Size, content, (item->Offset + 1), (item->Length - 2), VType::StringT);
-
-                            if (items[item_id].NestMatch.Size == 0) {
-                                document.Strings += String::Part(content, (items[item_id].Offset + 1), (items[item_id].Length - 2));
-                            } else {
-                                document.Strings += Engine::Parse(items[item_id].NestMatch, content, (items[item_id].Offset + 1),
-                                                                  (items[item_id].Length - 2));
-                            }
+            *to = *str;
+            ++to;
+            ++str;
+        }
 
-                            ++item_id;
-                            done = true;
-                            break;
-                        }
-                        case ':': {
-                            current_offset = x + 1;
-                            continue;
-                        }
-                        case '{':
-                        case '[': {
+        value.Length            = static_cast<UNumber>(to - value.Str);
+        value.Str[value.Length] = '\0';
 
-                            document.InsertHash(document.Documents.Size, content, (item->Offset + 1), (item->Length - 2), VType::DocumentT);
-                            document.Documents += makeList(items[item_id].NestMatch, content, items[item_id].Offset, items[item_id].Length);
+        return value;
+    }
 
-                            items[item_id].NestMatch.Reset();
-                            ++item_id;
-                            done = true;
-                            break;
-                        }
+    // A value goes to the entry of the key that came before it, or to the end of an array; in an object, one without a key is
+    // dropped.
+    static bool addJSONEntry(Document &document, StringView &key, const UNumber id, const VType type) noexcept {
+        if (document.Ordered) {
+            document.Entries += {type, 0, id};
+        } else if (key.Str != nullptr) {
+            document.InsertHash(id, key.Str, 0, key.Length, type);
+            key.Str = nullptr;
+        } else {
+            return false;
+        }
+
+        return true;
+    }
+
+    static bool buildJSON(const UShort event, const StringView &value, void *other) noexcept {
+        JSONBuilder &jb = *(static_cast<JSONBuilder *>(other));
+
+        if ((event == JSON::Events::OBJECT) || (event == JSON::Events::ARRAY)) {
+            jb.Docs.Emplace().Ordered = (event == JSON::Events::ARRAY);
+            jb.Keys.Emplace();
+            return true;
+        }
+
+        Document &  doc = jb.Docs[(jb.Docs.Size - 1)];
+        StringView &key = jb.Keys[(jb.Keys.Size - 1)];
+        double      number;
+
+        switch (event) {
+            case JSON::Events::KEY: {
+                key = value;
+                break;
+            }
+            case JSON::Events::STRING: {
+                if (addJSONEntry(doc, key, doc.Strings.Size, VType::StringT)) {
+                    doc.Strings += jsonString(value.Str, 0, value.Length);
+                }
+
+                break;
+            }
+            case JSON::Events::NUMBER: {
+                if (!String::ToNumber(number, value.Str, 0, value.Length)) {
+                    key.Str = nullptr; // Its key goes with it.
+                } else if (addJSONEntry(doc, key, doc.Numbers.Size, VType::NumberT)) {
+                    doc.Numbers += number;
+                }
+
+                break;
+            }
+            case JSON::Events::TRUE_VALUE: {
+                addJSONEntry(doc, key, 0, VType::TrueT);
+                break;
+            }
+            case JSON::Events::FALSE_VALUE: {
+                addJSONEntry(doc, key, 0, VType::FalseT);
+                break;
+            }
+            case JSON::Events::NULL_VALUE: {
+                addJSONEntry(doc, key, 0, VType::NullT);
+                break;
+            }
+            default: { // The end of an object or an array.
+                if (jb.Docs.Size == 1) {
+                    *jb.Result = static_cast<Document &&>(doc);
+                } else {
+                    Document &parent = jb.Docs[(jb.Docs.Size - 2)];
+
+                    if (addJSONEntry(parent, jb.Keys[(jb.Keys.Size - 2)], parent.Documents.Size, VType::DocumentT)) {
+                        parent.Documents += static_cast<Document &&>(doc);
                     }
+                }
 
-                    if (done) {
-                        done = false;
-                        break;
+                jb.Docs.Remove(jb.Docs.Size - 1);
+                jb.Keys.Remove(jb.Keys.Size - 1);
+            }
+        }
+
+        return true;
+    }
+
+    // Builds document from the first object or array in content; false: there is none, or the text ends before it does.
+    // Whatever comes after it is left out.
+    static bool parseJSON(Document &document, const char *content, const UNumber offset, const UNumber limit) noexcept {
+        JSONBuilder jb;
+        jb.Result = &document;
+
+        return JSON::Read(content, offset, limit, &(buildJSON), &jb);
+    }
+
+    // A number, true, false or null in content[offset, end), the way JSON::Reader reads them.
+    static void addJSONLiteral(Document &document, StringView &key, const char *content, UNumber offset, const UNumber end) noexcept {
+        UNumber length = (end - offset);
+        double  number;
+
+        String::SoftTrim(content, offset, length);
+
+        if (length != 0) {
+            switch (content[offset]) {
+                case 't': {
+                    addJSONEntry(document, key, 0, VType::TrueT);
+                    break;
+                }
+                case 'f': {
+                    addJSONEntry(document, key, 0, VType::FalseT);
+                    break;
+                }
+                case 'n': {
+                    addJSONEntry(document, key, 0, VType::NullT);
+                    break;
+                }
+                default: {
+                    if (String::ToNumber(number, content, offset, length) &&
+                        addJSONEntry(document, key, document.Numbers.Size, VType::NumberT)) {
+                        document.Numbers += number;
                     }
                 }
             }
-        } else {
-            document.Ordered = true;
+        }
+    }
 
-            for (x = current_offset; x < end; x++) {
-                while (content[x] == ' ') {
-                    ++x;
+    // Builds the entries of a lazy document from its part of the text, like buildJSON() does from the events of JSON::Read().
+    // The objects and the arrays in it are lazy too, and they are skipped by where they close, so every level of the text is
+    // walked once, the first time that something looks into it.
+    void loadJSON() noexcept {
+        const JSONPart    part(static_cast<JSONPart &&>(Lazy)); // Frees the text when it goes, if nothing else points into it.
+        const JSONSource &source    = *(part.Source);
+        const char *      content   = source.Content.Str;
+        const UNumber *   index     = source.Structurals.Storage;
+        const UNumber     last      = source.Closes[part.At];
+        UNumber           value_at  = (index[part.At] + 1);
+        bool              has_value = false;
+        StringView        key;
+
+        for (UNumber i = (part.At + 1); i < last; i++) {
+            const UNumber pos = index[i];
+
+            switch (content[pos]) {
+                case '{':
+                case '[': {
+                    has_value = (has_value || Ordered || (key.Str != nullptr));
+
+                    if (addJSONEntry(*this, key, Documents.Size, VType::DocumentT)) {
+                        Document &doc = Documents.Emplace();
+                        doc.Ordered   = (content[pos] == '[');
+                        doc.Lazy      = JSONPart(part.Source, i);
+                    }
+
+                    i = source.Closes[i];
+                    break;
                 }
+                case '"': {
+                    ++i;
+                    const UNumber length = (index[i] - pos - 1);
 
-                switch (content[x]) {
-                    case ',':
-                    case ']': {
-                        if (!done) {
-                            // A Number, true/false or null
-                            UNumber limit = (x - current_offset);
-                            String::SoftTrim(content, current_offset, limit);
-
-                            switch (content[current_offset]) {
-
-                                case 'f': {
-                                    // False
-                                    document.Entries += {VType::FalseT, 0, 0};
-                                    break;
-                                }
-                                case 't': {
-                                    // True
-                                    document.Entries += {VType::TrueT, 0, 0};
-                                    break;
-                                }
-                                case 'n': {
-                                    // Null
-                                    document.Entries += {VType::NullT, 0, 0};
-                                    break;
-                                }
-                                default: {
-                                    // A number
-                                    double number;
-                                    if (String::ToNumber(number, content, current_offset, limit)) {
-                                        document.Entries += {VType::NumberT, 0, document.Numbers.Size};
-                                        document.Numbers += number;
-                                    }
-                                    break;
-                                }
-                            }
+                    if (!Ordered && (key.Str == nullptr)) {
+                        key = StringView(content, (pos + 1), length);
+                    } else {
+                        has_value = true;
+
+                        if (addJSONEntry(*this, key, Strings.Size, VType::StringT)) {
+                            Strings += jsonString(content, (pos + 1), length);
                         }
+                    }
 
-                        current_offset = (x + 1);
-                        done           = false;
-                        break;
+                    break;
+                }
+                case ':': {
+                    value_at = (pos + 1);
+                    break;
+                }
+                default: { // ,
+                    if (!has_value) {
+                        addJSONLiteral(*this, key, content, value_at, pos);
                     }
-                    case '"': {
-                        item = &(items[item_id++]);
 
-                        document.Entries += {VType::StringT, 0, document.Strings.Size};
+                    value_at  = (pos + 1);
+                    has_value = false;
+                    key.Str   = nullptr;
+                }
+            }
+        }
 
-                        if (item->NestMatch.Size == 0) {
-                            document.Strings += String::Part(content, (item->Offset + 1), (item->Length - 2));
-                        } else {
-                            document.Strings += Engine::Parse(item->NestMatch, content, (item->Offset + 1), (item->Length - 2));
-                        }
+        if (!has_value) {
+            addJSONLiteral(*this, key, content, value_at, index[last]);
+        }
+    }
 
-                        x    = ((item->Offset + item->Length) - 1);
-                        done = true;
-                        break;
-                    }
-                    case '{':
-                    case '[': {
-                        item = &(items[item_id++]);
+    // Finds where every { and [ of source closes, from the first one on; false if that one never does.
+    static bool closeJSON(JSONSource &source, UNumber &first) noexcept {
+        const char *   content = source.Content.Str;
+        const UNumber *index   = source.Structurals.Storage;
+        const UNumber  size    = source.Structurals.Size;
+        Array<UNumber> open;
 
-                        document.Entries += {VType::DocumentT, 0, document.Documents.Size};
+        source.Closes.Expand(size);
+        first = 0;
 
-                        document.Documents += makeList(item->NestMatch, content, item->Offset, item->Length);
+        while ((first < size) && (content[index[first]] != '{') && (content[index[first]] != '[')) {
+            ++first;
+        }
 
-                        item->NestMatch.Reset();
+        for (UNumber i = first; i < size; i++) {
+            switch (content[index[i]]) {
+                case '{':
+                case '[': {
+                    open += i;
+                    break;
+                }
+                case '}':
+                case ']': {
+                    source.Closes[open[(open.Size - 1)]] = i;
+                    open.Remove(open.Size - 1);
 
-                        x    = ((item->Offset + item->Length) - 1);
-                        done = true;
-                        break;
+                    if (open.Size == 0) {
+                        return true;
                     }
+
+                    break;
                 }
+                default:
+                    break;
             }
         }
 
-        items.Reset();
-
-        return document;
+        return false;
     }
 
-    static Document FromJSON(const char *content, const UNumber offset, const UNumber limit, const bool comments = false) noexcept {
-        if (content == nullptr) {
-            return Document();
-        }
+    // Like FromJSON(), but it only parses the first level of the document; every object and array in it is parsed the first time
+    // that something looks into it: GetSource() (and the getters and the loops of templates with it), operator[] or ToJSON().
+    // Until then, they keep a copy of the text and of where its structural bytes are, that they share.
+    // Not for threads: looking into it writes to it, even through const, and the count of the shared text is not atomic. Do not
+    // share the document, or a copy of it, with another thread until all of it has been loaded; ToJSON() loads all of it.
+    static Document FromJSONLazy(String &&content) noexcept {
+        Document    document;
+        JSONSource *source;
+        UNumber     first;
 
-        Array<MatchBit> items;
+        Memory::AllocateBit<JSONSource>(&source);
+        source->Content = static_cast<String &&>(content);
 
-        // C style comments
-        if (!comments) {
-            items = Engine::Match(getJsonExpres(), content, offset, limit);
-            if (items.Size != 0) {
-                return makeList(items[0].NestMatch, content, items[0].Offset, items[0].Length);
-            }
-        } else {
-            static Expressions comments_expres;
-            if (comments_expres.Size == 0) {
-                static Expression comment1;
-                comment1.SetHead("/*");
-                comment1.SetTail("*/");
-                comment1.SetReplace("\n");
+        const JSONPart part(source, 0); // Frees it, unless a document keeps it.
+        JSON::Index(source->Structurals, source->Content.Str, 0, source->Content.Length);
 
-                static Expression comment2;
-                comment2.SetHead("//");
-                comment2.SetTail("\n");
-                comment2.SetReplace("\n");
+        if (closeJSON(*source, first)) {
+            document.Ordered = (source->Content[source->Structurals[first]] == '[');
+            document.Lazy    = JSONPart(source, first);
+            document.Load();
+        }
 
-                comments_expres.Add(&comment1).Add(&comment2);
-            }
+        return document;
+    }
 
-            String n_content(Engine::Parse(Engine::Match(comments_expres, content, offset, limit), content, offset, limit));
-            items = Engine::Match(getJsonExpres(), n_content.Str, 0, n_content.Length);
+    static Document FromJSONLazy(const String &content) noexcept {
+        return FromJSONLazy(String(content));
+    }
+
+    static Document FromJSON(const char *content, const UNumber offset, const UNumber limit, const bool comments = false) noexcept {
+        Document document;
 
-            if (items.Size != 0) {
-                return makeList(items[0].NestMatch, n_content.Str, items[0].Offset, items[0].Length);
+        if (content != nullptr) {
+            // C style comments
+            if (!comments) {
+                parseJSON(document, content, offset, limit);
+            } else {
+                Sink n_content(limit);
+                Engine::ParseTo(n_content, getCommentsExpres(), content, offset, limit);
+                parseJSON(document, n_content.Str, 0, n_content.Length);
             }
         }
 
-        return Document();
+        return document;
     }
 
     static Document FromJSON(const String &content, const bool comments = false) noexcept {
@@ -706,6 +955,8 @@ struct Document {
             return nullptr;
         }
 
+        Load();
+
         const Document *doc = this;
 
         UNumber curent_offset = offset;
@@ -732,12 +983,16 @@ struct Document {
                 }
 
                 *entry = &(doc->Entries[entry_id]);
-            } else if ((*entry = doc->Exist(String::Hash(key, curent_offset, (end - curent_offset)), 0, doc->Table)) == nullptr) {
-                return nullptr;
+            } else {
+                const StringView name(key, curent_offset, (end - curent_offset));
+
+                if ((*entry = doc->Exist(name, String::Hash(name))) == nullptr) {
+                    return nullptr;
+                }
             }
 
             if ((*entry)->Type == VType::DocumentT) {
-                doc = &(doc->Documents[(*entry)->ArrayID]);
+                doc = &(doc->child((*entry)->ArrayID));
             }
 
             if (end == end_offset) {
@@ -787,6 +1042,7 @@ struct Document {
 
     bool GetString(String &value, const UNumber entryID) const noexcept {
         value.Reset();
+        Load();
 
         if (entryID < Entries.Size) {
             return GetString(value, Entries[entryID], *this);
@@ -808,6 +1064,46 @@ struct Document {
         return false;
     }
 
+    // Like GetString(), but it writes the value into a sink.
+    static bool GetString(Sink &value, const Entry &entry, const Document &parent) noexcept {
+        switch (entry.Type) {
+            case VType::NumberT: {
+                value += String::FromNumber(parent.Numbers[entry.ArrayID], 1, 0, 3);
+                return true;
+            }
+            case VType::StringT: {
+                value += parent.Strings[entry.ArrayID];
+                return true;
+            }
+            case VType::FalseT: {
+                value.Add("false", 5);
+                return true;
+            }
+            case VType::TrueT: {
+                value.Add("true", 4);
+                return true;
+            }
+            case VType::NullT: {
+                value.Add("null", 4);
+                return true;
+            }
+            default: {
+                return false;
+            }
+        }
+    }
+
+    bool GetString(Sink &value, const char *key, const UNumber offset, const UNumber limit) const noexcept {
+        Entry *         entry;
+        const Document *storage = GetSource(&entry, key, offset, limit);
+
+        if (storage != nullptr) {
+            return GetString(value, *entry, *storage);
+        }
+
+        return false;
+    }
+
     bool GetString(String &value, const char *key) noexcept {
         return GetString(value, key, 0, String::Count(key));
     }
@@ -926,25 +1222,33 @@ struct Document {
     }
 
     String ToJSON() const noexcept {
-        StringStream ss;
+        Sink ss((Entries.Size * 8) + 2);
+        ToJSON(ss);
+        return ss.ToString();
+    }
+
+    void ToJSON(Sink &ss) const noexcept {
         const Entry *entry;
         UNumber      counter;
+        bool         comma = false;
 
-        if (Ordered) {
-            ss.Bits.SetCapacity(2 + (Entries.Size * 2) + (Strings.Size * 2));
+        Load();
 
+        if (Ordered) {
             ss += JFX.fss4;
 
             for (UNumber i = 0; i < Entries.Size; i++) {
                 entry = &(Entries[i]);
 
-                if (ss.Length != 1) {
+                if (comma) {
                     ss += JFX.fss3;
                 }
 
+                comma = (comma || (entry->Type != VType::UndefinedT));
+
                 switch (entry->Type) {
                     case VType::NumberT: {
-                        ss += String::FromNumber(Numbers[entry->ArrayID]);
+                        numberToJSON(ss, Numbers[entry->ArrayID]);
                         break;
                     }
                     case VType::StringT: {
@@ -962,14 +1266,14 @@ struct Document {
                         if (counter == es.Length) {
                             ss += es;
                         } else {
-                            ss += Engine::Parse(Engine::Match(getToJsonExpres(), es.Str, 0, es.Length), es.Str, 0, es.Length);
+                            Engine::ParseTo(ss, Engine::Match(getToJsonExpres(), es.Str, 0, es.Length), es.Str, 0, es.Length);
                         }
 
                         ss += JFX.fss6;
                         break;
                     }
                     case VType::DocumentT: {
-                        ss += Documents[entry->ArrayID].ToJSON();
+                        child(entry->ArrayID).ToJSON(ss);
                         break;
                     }
                     case VType::FalseT: {
@@ -992,24 +1296,24 @@ struct Document {
 
             ss += JFX.fss5;
         } else {
-            ss.Bits.SetCapacity(2 + (Entries.Size * 6) + (Strings.Size * 2));
-
             ss += JFX.fss1;
 
             for (UNumber i = 0; i < Entries.Size; i++) {
                 entry = &(Entries[i]);
 
-                if (ss.Length != 1) {
+                if (comma) {
                     ss += JFX.fss3;
                 }
 
+                comma = (comma || (entry->Type != VType::UndefinedT));
+
                 switch (entry->Type) {
                     case VType::NumberT: {
                         ss += JFX.fss6;
                         ss += Keys[entry->KeyID];
                         ss += JFX.fss6;
                         ss += JFX.fsc1;
-                        ss += String::FromNumber(Numbers[entry->ArrayID]);
+                        numberToJSON(ss, Numbers[entry->ArrayID]);
                         break;
                     }
                     case VType::StringT: {
@@ -1031,7 +1335,7 @@ struct Document {
                         if (counter == es.Length) {
                             ss += es;
                         } else {
-                            ss += Engine::Parse(Engine::Match(getToJsonExpres(), es.Str, 0, es.Length), es.Str, 0, es.Length);
+                            Engine::ParseTo(ss, Engine::Match(getToJsonExpres(), es.Str, 0, es.Length), es.Str, 0, es.Length);
                         }
 
                         ss += JFX.fss6;
@@ -1042,7 +1346,7 @@ struct Document {
                         ss += Keys[entry->KeyID];
                         ss += JFX.fss6;
                         ss += JFX.fsc1;
-                        ss += Documents[entry->ArrayID].ToJSON();
+                        child(entry->ArrayID).ToJSON(ss);
                         break;
                     }
                     case VType::FalseT: {
@@ -1077,11 +1381,20 @@ struct Document {
 
             ss += JFX.fss2;
         }
+    }
 
-        return ss.ToString();
+    // JSON has no NaN nor infinities, so they are written as null; templates still get them as JavaScript writes them.
+    static void numberToJSON(Sink &ss, const double number) noexcept {
+        if ((number - number) == 0.0) {
+            ss += String::FromNumber(number);
+        } else {
+            ss += JFX.fNull;
+        }
     }
 
     static const Expressions &getToJsonExpres() noexcept {
+        const Memory::AllocatorScope global(nullptr);
+
         static Expressions expres;
 
         if (expres.Size == 0) {
@@ -1114,7 +1427,31 @@ struct Document {
         return expres;
     }
 
+    static const Expressions &getCommentsExpres() noexcept {
+        const Memory::AllocatorScope global(nullptr);
+
+        static Expressions expres;
+
+        if (expres.Size == 0) {
+            static Expression comment1;
+            comment1.SetHead("/*");
+            comment1.SetTail("*/");
+            comment1.SetReplace("\n");
+
+            static Expression comment2;
+            comment2.SetHead("//");
+            comment2.SetTail("\n");
+            comment2.SetReplace("\n");
+
+            expres.Add(&comment1).Add(&comment2);
+        }
+
+        return expres;
+    }
+
     static const Expressions &getJsonExpres() noexcept {
+        const Memory::AllocatorScope global(nullptr);
+
         static Expressions expres;
 
         if (expres.Size == 0) {
@@ -1142,8 +1479,7 @@ struct Document {
             quotation.HLength = 1;
             quotation.Tail    = &(char_list[6]);
             quotation.TLength = 1;
-            quotation.NestExpres += &esc_esc;
-            quotation.NestExpres += &esc_quotation;
+            quotation.NestExpres.Add(&esc_esc).Add(&esc_quotation);
 
             static Expression curly_bracket;
             // curly_bracket.SetHead("{");
@@ -1174,6 +1510,9 @@ struct Document {
     }
 
     void operator+=(const Document &doc) noexcept {
+        Load();
+        doc.Load();
+
         if (Ordered != doc.Ordered) {
             if (Entries.Size != 0) {
                 // Not the same type!
@@ -1246,6 +1585,9 @@ struct Document {
     }
 
     void operator+=(Document &&doc) noexcept {
+        Load();
+        doc.Load();
+
         if (Ordered != doc.Ordered) {
             if (Entries.Size != 0) {
                 // Not the same type!
@@ -1320,13 +1662,13 @@ struct Document {
     Document &operator=(Document &&doc) noexcept {
         if (LastKeyLen == 0) {
             Ordered   = doc.Ordered;
-            HashBase  = doc.HashBase;
             Keys      = static_cast<Array<String> &&>(doc.Keys);
             Table     = static_cast<Array<Index> &&>(doc.Table);
             Entries   = static_cast<Array<Entry> &&>(doc.Entries);
             Numbers   = static_cast<Array<double> &&>(doc.Numbers);
             Strings   = static_cast<Array<String> &&>(doc.Strings);
             Documents = static_cast<Array<Document> &&>(doc.Documents);
+            Lazy      = static_cast<JSONPart &&>(doc.Lazy);
             return *this;
         }
 
@@ -1353,13 +1695,13 @@ struct Document {
     Document &operator=(const Document &doc) noexcept {
         if (LastKeyLen == 0) {
             Ordered   = doc.Ordered;
-            HashBase  = doc.HashBase;
             Keys      = doc.Keys;
             Table     = doc.Table;
             Entries   = doc.Entries;
             Numbers   = doc.Numbers;
             Strings   = doc.Strings;
             Documents = doc.Documents;
+            Lazy      = doc.Lazy;
             return *this;
         }
 
@@ -1701,22 +2043,25 @@ struct Document {
     }
 
     Document &operator[](const char *key) noexcept {
+        Load();
+
         const UNumber str_len = String::Count(key);
 
         if (Ordered) {
             UNumber id;
             if (String::ToNumber(id, key, 0, str_len)) {
                 if (Entries[id].Type == VType::DocumentT) {
-                    return Documents[Entries[id].ArrayID];
+                    return child(Entries[id].ArrayID);
                 }
 
                 LastKeyLen = (id + 1);
             }
         } else {
-            const Entry *entry = Exist(String::Hash(key, 0, str_len), 0, Table);
+            const StringView name(key, str_len);
+            const Entry *    entry = Exist(name, String::Hash(name));
 
             if ((entry != nullptr) && (entry->Type == VType::DocumentT)) {
-                return Documents[entry->ArrayID];
+                return child(entry->ArrayID);
             }
 
             LastKey    = key;
@@ -1727,20 +2072,22 @@ struct Document {
     }
 
     Document &operator[](const String &key) noexcept {
+        Load();
+
         if (Ordered) {
             UNumber id;
             if (String::ToNumber(id, key.Str, 0, key.Length)) {
                 if (Entries[id].Type == VType::DocumentT) {
-                    return Documents[Entries[id].ArrayID];
+                    return child(Entries[id].ArrayID);
                 }
 
                 LastKeyLen = (id + 1);
             }
         } else {
-            const Entry *entry = Exist(String::Hash(key.Str, 0, key.Length), 0, Table);
+            const Entry *entry = Exist(key.View(), String::Hash(key.View()));
 
             if ((entry != nullptr) && (entry->Type == VType::DocumentT)) {
-                return Documents[entry->ArrayID];
+                return child(entry->ArrayID);
             }
 
             LastKey    = key.Str;
@@ -1751,11 +2098,13 @@ struct Document {
     }
 
     Document &operator[](const UNumber id) noexcept {
+        Load();
+
         if (id < Entries.Size) {
             const Entry &entry = Entries[id];
 
             if (entry.Type == VType::DocumentT) {
-                return Documents[entry.ArrayID];
+                return child(entry.ArrayID);
             }
 
             if (Ordered) {
@@ -1776,13 +2125,15 @@ struct Document {
     }
 
     Document &operator[](const int id) noexcept {
+        Load();
+
         const UNumber ID = static_cast<UNumber>(id);
 
         if (ID < Entries.Size) {
             const Entry &entry = Entries[ID];
 
             if (entry.Type == VType::DocumentT) {
-                return Documents[entry.ArrayID];
+                return child(entry.ArrayID);
             }
 
             if (Ordered) {
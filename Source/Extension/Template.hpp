@@ -24,8 +24,15 @@ static const Expressions &getVarExpres() noexcept;
 static const Expressions &getQuotesExpres() noexcept;
 static const Expressions &getHeadExpres() noexcept;
 
+static void Render(Sink &sink, const char *content, const UNumber offset, const UNumber limit, void *data) noexcept {
+    Engine::ParseTo(sink, Engine::Match(getExpres(), content, offset, limit), content, offset, limit, data);
+}
+
 static String Render(const char *content, const UNumber offset, const UNumber limit, void *data) noexcept {
-    return Engine::Parse(Engine::Match(getExpres(), content, offset, limit), content, offset, limit, data);
+    Sink rendered(limit);
+    Render(rendered, content, offset, limit, data);
+
+    return rendered.ToString();
 }
 
 inline static String Render(const String &content, Document *data) noexcept {
@@ -35,77 +42,77 @@ inline static String Render(const String &content, Document *data) noexcept {
 // e.g. {v:var_name}
 // e.g. {v:var_name[id]}
 // Nest: {v:var_{v:var2_{v:var3_id}}}
-static String RenderVar(const char *block, const MatchBit &item, const UNumber length, void *other) noexcept {
-    String value;
-
-    if (!(static_cast<Document *>(other))->GetString(value, block, (item.Offset + 3), (item.Length - 4))) {
-        value = String::Part(block, (item.Offset + 3), (item.Length - 4));
+static void RenderVar(Sink &sink, const char *block, const MatchBit &item, const UNumber length, void *other) noexcept {
+    if (!(static_cast<Document *>(other))->GetString(sink, block, (item.Offset + 3), (item.Length - 4))) {
+        sink.Add(&(block[(item.Offset + 3)]), (item.Length - 4));
     }
-
-    return value;
 }
 
-static String RenderMath(const char *block, const MatchBit &item, const UNumber length, void *other) noexcept {
-    return String::FromNumber(ALE::Evaluate(block, 6, (length - 7)), 1, 0, 3);
+static void RenderMath(Sink &sink, const char *block, const MatchBit &item, const UNumber length, void *other) noexcept {
+    sink += String::FromNumber(ALE::Evaluate(block, 6, (length - 7)), 1, 0, 3);
 }
 
 // {iif case="3 == 3" true="Yes" false="No"}
 // {iif case="{v:var_five} == 5" true="5" false="no"}
 // {iif case="{v:var_five} == 5" true="{v:var_five} is equal to 5" false="no"}
 // {iif case="3 == 3" true="Yes" false="No"}
-static String RenderIIF(const char *block, const MatchBit &item, const UNumber length, void *other) noexcept {
-    const Array<MatchBit> items(Engine::Match(getQuotesExpres(), block, 0, length));
-
-    bool            iif_case = false;
-    const MatchBit *m;
-    const MatchBit *iif_true  = nullptr;
-    const MatchBit *iif_false = nullptr;
-    UNumber         start_at;
+// The parts of an iif tag.
+struct IIFParts {
+    MatchBit True{};
+    MatchBit False{};
+    bool     Case{false};
+};
+
+// Visits the quotes of an iif tag.
+static void visitIIF(const char *block, const MatchBit &item, const UShort event, void *other) noexcept {
+    IIFParts *parts = static_cast<IIFParts *>(other);
+    UNumber   start_at;
 
     // case="[statement]" true="[Yes]" false="[No]"
-    for (UNumber i = 0; i < items.Size; i++) {
-        // With this method, order is not necessary of case=, true=, false=
-        m = &(items[i]);
-        if (m->Offset > 5) {
-            start_at = m->Offset - 3;
-
-            while ((start_at <= m->Offset) && (start_at != 0)) {
-                --start_at;
-
-                if (block[start_at] == 'a') { // c[a]se
-                    iif_case = (ALE::Evaluate(block, (m->Offset + 1), (m->Length - 2)) > 0.0);
-                    break;
-                }
+    // With this method, order is not necessary of case=, true=, false=
+    if (item.Offset > 5) {
+        start_at = item.Offset - 3;
 
-                if (block[start_at] == 'r') { // t[r]ue
-                    iif_true = m;
-                    break;
-                }
+        while ((start_at <= item.Offset) && (start_at != 0)) {
+            --start_at;
 
-                if (block[start_at] == 'l') { // fa[l]se
-                    iif_false = m;
-                    break;
-                }
+            if (block[start_at] == 'a') { // c[a]se
+                parts->Case = (ALE::Evaluate(block, (item.Offset + 1), (item.Length - 2)) > 0.0);
+                break;
+            }
+
+            if (block[start_at] == 'r') { // t[r]ue
+                parts->True = item;
+                break;
+            }
+
+            if (block[start_at] == 'l') { // fa[l]se
+                parts->False = item;
+                break;
             }
         }
     }
+}
+
+static void RenderIIF(Sink &sink, const char *block, const MatchBit &item, const UNumber length, void *other) noexcept {
+    IIFParts parts;
+    Engine::Visit(getQuotesExpres(), block, 0, length, &(visitIIF), &parts);
 
-    if (iif_case) {
-        if (iif_true != nullptr) {
-            return String::Part(block, (iif_true->Offset + 1), (iif_true->Length - 2));
+    if (parts.Case) {
+        if (parts.True.Length != 0) {
+            sink.Add(&(block[(parts.True.Offset + 1)]), (parts.True.Length - 2));
         }
-    } else if (iif_false != nullptr) {
-        return String::Part(block, (iif_false->Offset + 1), (iif_false->Length - 2));
+    } else if (parts.False.Length != 0) {
+        sink.Add(&(block[(parts.False.Offset + 1)]), (parts.False.Length - 2));
     }
-
-    return String();
 }
 
 static bool EvaluateIF(const char *block, const MatchBit &item, void *other) noexcept {
     const UNumber offset = (item.Offset + 1);
     const UNumber limit  = (item.Length - 2);
 
-    const String content(Engine::Parse(Engine::Match(getVarExpres(), block, offset, limit), block, offset, limit, other));
+    Sink content(limit);
+    Engine::ParseTo(content, Engine::Match(getVarExpres(), block, offset, limit), block, offset, limit, other);
 
     return (ALE::Evaluate(content.Str, 0, content.Length) > 0.0);
 }
@@ -114,11 +121,11 @@ static bool EvaluateIF(const char *block, const MatchBit &item, void *other) noe
 // <if case="{case}">html code1 <else /> html code2</if>
 // <if case="{case1}">html code1 <elseif case={case2} /> html code2</if>
 // <if case="{case}">html code <if case="{case2}" />additional html code</if></if>
-static String RenderIF(const char *block, const MatchBit &item, const UNumber length, void *other) noexcept {
+static void RenderIF(Sink &sink, const char *block, const MatchBit &item, const UNumber length, void *other) noexcept {
     // Nothing is processed inside the match before checking if the condition is TRUE.
     bool is_true = false;
 
-    Array<MatchBit> subMatch(Engine::Match(getHeadExpres(), block, item.Offset, item.Length));
+    MatchTree subMatch(Engine::Match(getHeadExpres(), block, item.Offset, item.Length));
 
     if (subMatch.Size != 0) {
         MatchBit *sm = &(subMatch[0]);
@@ -139,7 +146,7 @@ static String RenderIF(const char *block, const MatchBit &item, const UNumber le
                 } else {
                     for (UNumber i = 1; i < item.NestMatch.Size; i++) {
                         offset   = (nm->Offset + nm->Length);
-                        subMatch = Engine::Match(getHeadExpres(), block, offset, (length - nm->Length));
+                        subMatch = Engine::Match(getHeadExpres(), block, offset, ((item.Offset + item.Length) - offset));
 
                         // inner content of the next part.
                         nm     = &(item.NestMatch[i]);
@@ -156,16 +163,14 @@ static String RenderIF(const char *block, const MatchBit &item, const UNumber le
             }
 
             if (is_true) {
-                return Render(block, offset, limit, other);
+                Render(sink, block, offset, limit, other);
             }
         }
     }
-
-    return String();
 }
 
-static String Repeat(const char *block, const UNumber offset, const UNumber limit, Expression &key_expr, Expression &value_expr,
-                     const MatchBit *set_, void *other) noexcept {
+static void Repeat(Sink &rendered, const char *block, const UNumber offset, const UNumber limit, Expression &key_expr,
+                   Expression &value_expr, const MatchBit *set_, void *other) noexcept {
     Expressions loop_expres(2);
 
     if (key_expr.HLength != 0) {
@@ -174,9 +179,8 @@ static String Repeat(const char *block, const UNumber offset, const UNumber limi
 
     loop_expres.Add(&value_expr);
 
-    const Array<MatchBit> items(Engine::Match(loop_expres, block, offset, limit));
+    const MatchTree items(Engine::Match(loop_expres, block, offset, limit));
 
-    StringStream  rendered;
     const String *str_ptr;
     String        value;
     String        key;
@@ -241,19 +245,17 @@ static String Repeat(const char *block, const UNumber offset, const UNumber limi
                 }
             }
 
-            rendered += Engine::Parse(items, block, offset, limit);
+            Engine::ParseTo(rendered, items, block, offset, limit);
         }
     }
-
-    return rendered.ToString();
 }
 
 // <loop set="abc2" value="s_value" key="s_key">
 //     <span>s_key: s_value</span>
 // </loop>
-static String RenderLoop(const char *block, const MatchBit &item, const UNumber length, void *other) noexcept {
+static void RenderLoop(Sink &sink, const char *block, const MatchBit &item, const UNumber length, void *other) noexcept {
     // To match: <loop (set="abc2" value="s_value" key="s_key")>
-    const Array<MatchBit> subMatch(Engine::Match(getHeadExpres(), block, item.Offset, item.Length));
+    const MatchTree subMatch(Engine::Match(getHeadExpres(), block, item.Offset, item.Length));
 
     if ((subMatch.Size != 0) && (subMatch[0].NestMatch.Size != 0)) {
         const MatchBit *set_ = nullptr;
@@ -262,6 +264,10 @@ static String RenderLoop(const char *block, const MatchBit &item, const UNumber
 
         const MatchBit *sm = &(subMatch[0]);
 
+        if ((sm->Length + 7) > item.Length) {
+            return; // The head runs into </loop>; there is no content.
+        }
+
         // set="(Array_name)" value="s_value" key="s_key"
         const MatchBit *m;
         UNumber         start_at;
@@ -295,15 +301,19 @@ static String RenderLoop(const char *block, const MatchBit &item, const UNumber
         }
 
         if ((value_expr.Head != nullptr) || (key_expr.Head != nullptr)) {
-            String n_content(Repeat(block, (sm->Offset + sm->Length), (item.Length - (sm->Length + 7)), key_expr, value_expr, set_, other));
-            return Render(n_content.Str, 0, n_content.Length, other);
+            const UNumber offset = (sm->Offset + sm->Length);
+            const UNumber limit  = (item.Length - (sm->Length + 7));
+
+            Sink n_content(limit);
+            Repeat(n_content, block, offset, limit, key_expr, value_expr, set_, other);
+            Render(sink, n_content.Str, 0, n_content.Length, other);
         }
     }
-
-    return String();
 }
 
 static const Expressions &getVarExpres() noexcept {
+    const Memory::AllocatorScope global(nullptr);
+
     static Expressions expres(1);
 
     if (expres.Size == 0) {
@@ -311,8 +321,8 @@ static const Expressions &getVarExpres() noexcept {
         static Expression var_;
         var_.SetHead("{v:");
         var_.SetTail("}");
-        var_.Flag    = Flags::TRIM;
-        var_.ParseCB = &(Template::RenderVar);
+        var_.Flag      = Flags::TRIM;
+        var_.ParseToCB = &(Template::RenderVar);
 
         expres.Add(&var_);
     }
@@ -321,6 +331,8 @@ static const Expressions &getVarExpres() noexcept {
 }
 
 static const Expressions &getQuotesExpres() noexcept {
+    const Memory::AllocatorScope global(nullptr);
+
     static Expressions expres(1);
 
     if (expres.Size == 0) {
@@ -335,6 +347,8 @@ static const Expressions &getQuotesExpres() noexcept {
 }
 
 static const Expressions &getHeadExpres() noexcept {
+    const Memory::AllocatorScope global(nullptr);
+
     static Expressions expres(1);
 
     if (expres.Size == 0) {
@@ -352,6 +366,8 @@ static const Expressions &getHeadExpres() noexcept {
 }
 
 static const Expressions &getExpres() noexcept {
+    const Memory::AllocatorScope global(nullptr);
+
     static Expressions expres(5);
 
     if (expres.Size == 0) {
@@ -359,8 +375,8 @@ static const Expressions &getExpres() noexcept {
         static Expression tag_iif;
         tag_iif.SetHead("{iif");
         tag_iif.SetTail("}");
-        tag_iif.Flag    = Flags::BUBBLE;
-        tag_iif.ParseCB = &(Template::RenderIIF);
+        tag_iif.Flag      = Flags::BUBBLE;
+        tag_iif.ParseToCB = &(Template::RenderIIF);
         tag_iif.NestExpres.SetCapacity(1);
         tag_iif.NestExpres.Add(getVarExpres());
         /////////////////////////////////
@@ -388,9 +404,9 @@ static const Expressions &getExpres() noexcept {
         tag_if.Head    = tag_empty_if.Head;
         tag_if.HLength = tag_empty_if.HLength;
         // tag_if.SetTail("</if>");
-        tag_if.Tail    = tag_empty_if.Tail;
-        tag_if.TLength = tag_empty_if.TLength;
-        tag_if.ParseCB = &(Template::RenderIF);
+        tag_if.Tail      = tag_empty_if.Tail;
+        tag_if.TLength   = tag_empty_if.TLength;
+        tag_if.ParseToCB = &(Template::RenderIF);
         tag_if.NestExpres.Add(&tag_empty_if).Add(&tag_else_if);
         /////////////////////////////////
 
@@ -400,7 +416,7 @@ static const Expressions &getExpres() noexcept {
         static Expression tag_loop;
         tag_loop.SetHead("<loop");
         tag_loop.SetTail("</loop>");
-        tag_loop.ParseCB = &(Template::RenderLoop);
+        tag_loop.ParseToCB = &(Template::RenderLoop);
         tag_loop.NestExpres.SetCapacity(1);
         tag_loop.NestExpres.Add(&tag_loop); // Nested by itself
         /////////////////////////////////
@@ -410,8 +426,8 @@ static const Expressions &getExpres() noexcept {
         static Expression tag_math;
         tag_math.SetHead("{math:");
         tag_math.SetTail("}");
-        tag_math.Flag    = Flags::TRIM | Flags::BUBBLE;
-        tag_math.ParseCB = &(Template::RenderMath);
+        tag_math.Flag      = Flags::TRIM | Flags::BUBBLE;
+        tag_math.ParseToCB = &(Template::RenderMath);
         tag_math.NestExpres.SetCapacity(1);
         tag_math.NestExpres.Add(getVarExpres());
         /////////////////////////////////
@@ -20,6 +20,8 @@ using Qentem::Engine::Expression;
 using Qentem::Engine::Expressions;
 using Qentem::Engine::Flags;
 using Qentem::Engine::MatchBit;
+using Qentem::Engine::MatchList;
+using Qentem::Engine::MatchTree;
 
 struct XProperty {
     String Name{};
@@ -44,6 +46,8 @@ static void InfinitSpaceCallback(const char *content, UNumber &offset, const UNu
 }
 
 static const Expressions &getXMLExpres() noexcept {
+    const Memory::AllocatorScope global(nullptr);
+
     static Expressions expres(1);
 
     if (expres.Size == 0) {
@@ -51,13 +55,15 @@ static const Expressions &getXMLExpres() noexcept {
         tag.SetHead("<");
         tag.SetTail(">");
 
-        expres += &tag;
+        expres.Add(&tag);
     }
 
     return expres;
 }
 
 static const Expressions &getPropertiesExpres() noexcept {
+    const Memory::AllocatorScope global(nullptr);
+
     static Expressions expres(3);
 
     if (expres.Size == 0) {
@@ -82,125 +88,126 @@ static const Expressions &getPropertiesExpres() noexcept {
     return expres;
 }
 
-static Array<XTag> parseTags(const String &content, const Array<MatchBit> &items, UNumber id, const UNumber count) noexcept {
+// The tags that Parse() has found so far.
+struct XBuilder {
+    Array<XTag>    Tags{};
+    Array<XTag>    Open{};    // Tags that wait for their closing tag; each one goes inside the one before it.
+    Array<UNumber> Inner{};   // Where the inner text of each open tag starts.
+    MatchTree      Matches{}; // The properties of a tag.
+};
+
+// Moves the last open tag to the tags that hold it.
+static void closeTag(XBuilder &xb) noexcept {
+    XTag tag;
+    tag = static_cast<XTag &&>(xb.Open[(xb.Open.Size - 1)]);
 
-    static const Expressions &propertiesExpres = getPropertiesExpres();
+    xb.Open.Remove(xb.Open.Size - 1);
+    xb.Inner.Remove(xb.Inner.Size - 1);
 
-    Array<XTag> tags;
-    XTag        x_tag;
+    if (xb.Open.Size != 0) {
+        xb.Open[(xb.Open.Size - 1)].InnerNodes += static_cast<XTag &&>(tag);
+    } else {
+        xb.Tags += static_cast<XTag &&>(tag);
+    }
+}
 
-    UNumber startAt;
-    UNumber tagLen;
-    UNumber repeated = 0;
+// An open tag without a closing one: it has no inner nodes, and the tags inside it go after it.
+static void dropTag(XBuilder &xb) noexcept {
+    Array<XTag> inner;
+    inner = static_cast<Array<XTag> &&>(xb.Open[(xb.Open.Size - 1)].InnerNodes);
 
-    UNumber         matchStart = 0;
-    UNumber         tmpIndex   = 0;
-    UNumber         remlen;
-    Array<MatchBit> x_properties;
+    closeTag(xb);
 
-    MatchBit *item;
-    bool      tagged = false;
+    Array<XTag> &siblings = ((xb.Open.Size != 0) ? xb.Open[(xb.Open.Size - 1)].InnerNodes : xb.Tags);
 
-    for (UNumber index = 0; index < count;) {
-        item = &items[id];
+    for (UNumber i = 0; i < inner.Size; i++) {
+        siblings += static_cast<XTag &&>(inner[i]);
+    }
+}
 
-        startAt = (item->Offset + 1);
-        tagLen  = 0;
+static void visitTag(const char *content, const MatchBit &item, const UShort event, void *other) noexcept {
+    static const Expressions &propertiesExpres = getPropertiesExpres();
 
-        // Finding the name of the tag
-        for (UNumber x = startAt; ((content[x] != ' ') && (content[x] != '>')); ++x) {
-            ++tagLen;
-        }
+    XBuilder &    xb      = *(static_cast<XBuilder *>(other));
+    const UNumber startAt = (item.Offset + 1);
+    UNumber       tagLen  = 0;
 
-        if (tagged) {
-            if (content[startAt] != '/') {                          // If it's not a closing tag.
-                if (x_tag.Name.Compare(content, startAt, tagLen)) { // If it's equal to the current one.
-                    ++repeated;                                     // then it's a chiled tag.
-                }
-            } else if (x_tag.Name.Compare(content, (startAt + 1), (tagLen - 1))) {
-                // A closing tag and it's equal to the current one.
-                if (repeated != 0) {
-                    // if it has a chiled of the same tag, then the closing tag is
-                    // not for the undergoing tag; pass.
-                    --repeated;
-                } else {
-                    tagged = false; // The opening and the ending tag has been found.
-
-                    // Subtags
-                    UNumber   subStart  = matchStart + 1;
-                    UNumber   subCount  = id - subStart;
-                    UNumber   lastTag   = (tags.Size - 1);
-                    MatchBit *headItem  = &(items[matchStart]);
-                    UNumber   headStart = (headItem->Offset + headItem->Length);
-
-                    tags[lastTag].InnerText = String::Part(content.Str, headStart, (items[id].Offset - headStart));
-
-                    if (subCount != 0) {
-                        tags[lastTag].InnerNodes += parseTags(content, items, subStart, subCount);
-                    }
-                }
-            }
-        } else if (content[startAt] != '/') { // A new tag that is not a closing one.
-            x_tag.Name = String::Part(content.Str, startAt, tagLen);
-            // TODO: Add inline HTML tag list
+    // Finding the name of the tag
+    for (UNumber x = startAt; ((content[x] != ' ') && (content[x] != '>')); ++x) {
+        ++tagLen;
+    }
 
-            matchStart = id;
-            tmpIndex   = index;
+    if (content[startAt] == '/') {
+        // A closing tag: it closes the last open tag with the same name, and the ones after it have no closing tags.
+        UNumber id = xb.Open.Size;
 
-            // Paraperties
-            remlen = item->Length - tagLen - 2; // Remaining text.
-            tagged = (content[((item->Offset + item->Length) - 2)] != '/');
+        while ((id != 0) && (xb.Open[(id - 1)].Name != StringView(content, (startAt + 1), (tagLen - 1)))) {
+            --id;
+        }
 
-            if (!tagged) {
-                // Inline tag.
-                --remlen; // Forward slash
+        if (id != 0) {
+            while (xb.Open.Size != id) {
+                dropTag(xb);
             }
 
-            UNumber   startIndex = (startAt + tagLen);
-            XProperty xp;
-            MatchBit *xpMatch;
+            const UNumber inner_start   = xb.Inner[(id - 1)];
+            xb.Open[(id - 1)].InnerText = String::Part(content, inner_start, (item.Offset - inner_start));
+            closeTag(xb);
+        }
 
-            x_properties = Qentem::Engine::Match(propertiesExpres, content.Str, startIndex, remlen);
+        return;
+    }
 
-            for (UNumber p = 0; p < x_properties.Size;) {
-                xpMatch = &x_properties[p];
-                xp.Name = String::Part(content.Str, xpMatch->Offset, xpMatch->Length);
-                ++p;
+    XTag x_tag;
+    x_tag.Name = String::Part(content, startAt, tagLen);
 
-                xpMatch = &x_properties[p];
-                if (content[xpMatch->Offset] == '"') {
-                    xp.Value = String::Part(content.Str, (xpMatch->Offset + 1), (xpMatch->Length - 2));
-                } else {
-                    xp.Value = String::Part(content.Str, xpMatch->Offset, xpMatch->Length);
-                }
+    // Paraperties
+    const UNumber startIndex = (startAt + tagLen);
+    const bool    inline_tag = (content[((item.Offset + item.Length) - 2)] == '/');
+    UNumber       remlen     = (item.Length - tagLen - 2); // Remaining text.
 
-                ++p;
-                x_tag.Properties.Add(xp);
-            }
+    if (inline_tag) {
+        --remlen; // Forward slash
+    }
 
-            tags.Add(x_tag);
-        }
+    XProperty       xp;
+    const MatchBit *xpMatch;
+
+    Qentem::Engine::Match(xb.Matches, propertiesExpres, content, startIndex, remlen);
 
-        ++index;
+    for (UNumber p = 0; p < xb.Matches.Size;) {
+        xpMatch = &(xb.Matches[p]);
+        xp.Name = String::Part(content, xpMatch->Offset, xpMatch->Length);
+        ++p;
 
-        if ((index == count) && tagged) {
-            // Inline tag, or a tag without an ending tag.
-            tagged   = false;
-            index    = (tmpIndex + 1);
-            id       = matchStart;
-            repeated = 0; // Clear subtag count; it's not a parent.
+        xpMatch = &(xb.Matches[p]);
+        if (content[xpMatch->Offset] == '"') {
+            xp.Value = String::Part(content, (xpMatch->Offset + 1), (xpMatch->Length - 2));
+        } else {
+            xp.Value = String::Part(content, xpMatch->Offset, xpMatch->Length);
         }
 
-        ++id;
+        ++p;
+        x_tag.Properties += static_cast<XProperty &&>(xp);
     }
 
-    return tags;
+    xb.Open += static_cast<XTag &&>(x_tag);
+    xb.Inner += (item.Offset + item.Length);
+
+    if (inline_tag) {
+        closeTag(xb);
+    }
 }
 
 static Array<XTag> Parse(const String &content) noexcept {
-    const Array<MatchBit> items = Qentem::Engine::Match(getXMLExpres(), content.Str, 0, content.Length);
+    XBuilder xb;
+    Qentem::Engine::Visit(getXMLExpres(), content.Str, 0, content.Length, &(visitTag), &xb);
+
+    while (xb.Open.Size != 0) {
+        dropTag(xb);
+    }
 
-    return parseTags(content, items, 0, items.Size);
+    return static_cast<Array<XTag> &&>(xb.Tags);
 }
 
 } // namespace XMLParser
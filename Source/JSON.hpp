@@ -0,0 +1,480 @@
+/**
+ * Qentem JSON
+ *
+ * @brief     Reads JSON text, 64 bytes at a time, and reports what it finds; Document::FromJSON() builds on it.
+ *
+ * @author    Hani Ammar <hani.code@outlook.com>
+ * @copyright 2019 Hani Ammar
+ * @license   https://opensource.org/licenses/MIT
+ */
+
+#include "Array.hpp"
+#include "Platform.hpp"
+#include "String.hpp"
+
+#ifndef QENTEM_JSON_H
+#define QENTEM_JSON_H
+
+namespace Qentem {
+namespace JSON {
+
+// The stage 1 of simdjson (Geoff Langdale and Daniel Lemire, "Parsing Gigabytes of JSON per Second"): every byte of a block is
+// one bit of a mask, and strings, escapes and structural characters come out of a few operations on those masks, without a
+// branch for every byte.
+
+// Bit i is byte i of a block of 64.
+struct Masks {
+    unsigned long long Quotes;
+    unsigned long long Backslashes;
+    unsigned long long Structurals; // { } [ ] , :
+};
+
+// What one block leaves to the next.
+struct Carry {
+    unsigned long long OddBackslash{0}; // 1: the block ended in an odd run of backslashes, so the next byte is escaped.
+    unsigned long long InString{0};     // All ones: the block ended inside a string.
+};
+
+// [ and ] are { and } without the 0x20 bit, so two compares after an OR find all four.
+static inline void classify(Masks &masks, const char *block) noexcept {
+#if defined(QENTEM_AVX2)
+    const __m256i quote     = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i open      = _mm256_set1_epi8('{');
+    const __m256i close     = _mm256_set1_epi8('}');
+    const __m256i comma     = _mm256_set1_epi8(',');
+    const __m256i colon     = _mm256_set1_epi8(':');
+    const __m256i lower     = _mm256_set1_epi8(0x20);
+
+    masks.Quotes      = 0;
+    masks.Backslashes = 0;
+    masks.Structurals = 0;
+
+    for (UShort i = 0; i < 64; i += 32) {
+        const __m256i bytes   = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + i));
+        const __m256i bracket = _mm256_or_si256(bytes, lower);
+        const __m256i found   = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bracket, open), _mm256_cmpeq_epi8(bracket, close)),
+                                              _mm256_or_si256(_mm256_cmpeq_epi8(bytes, comma), _mm256_cmpeq_epi8(bytes, colon)));
+
+        masks.Quotes |= (static_cast<unsigned long long>(static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, quote))))
+                         << i);
+        masks.Backslashes |=
+            (static_cast<unsigned long long>(static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, backslash)))) << i);
+        masks.Structurals |= (static_cast<unsigned long long>(static_cast<unsigned int>(_mm256_movemask_epi8(found))) << i);
+    }
+#elif defined(QENTEM_SSE2)
+    const __m128i quote     = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i open      = _mm_set1_epi8('{');
+    const __m128i close     = _mm_set1_epi8('}');
+    const __m128i comma     = _mm_set1_epi8(',');
+    const __m128i colon     = _mm_set1_epi8(':');
+    const __m128i lower     = _mm_set1_epi8(0x20);
+
+    masks.Quotes      = 0;
+    masks.Backslashes = 0;
+    masks.Structurals = 0;
+
+    for (UShort i = 0; i < 64; i += 16) {
+        const __m128i bytes   = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i));
+        const __m128i bracket = _mm_or_si128(bytes, lower);
+        const __m128i found   = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bracket, open), _mm_cmpeq_epi8(bracket, close)),
+                                           _mm_or_si128(_mm_cmpeq_epi8(bytes, comma), _mm_cmpeq_epi8(bytes, colon)));
+
+        masks.Quotes |= (static_cast<unsigned long long>(static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, quote)))) << i);
+        masks.Backslashes |=
+            (static_cast<unsigned long long>(static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, backslash)))) << i);
+        masks.Structurals |= (static_cast<unsigned long long>(static_cast<unsigned int>(_mm_movemask_epi8(found))) << i);
+    }
+#else
+    masks.Quotes      = 0;
+    masks.Backslashes = 0;
+    masks.Structurals = 0;
+
+    for (UShort i = 0; i < 64; i++) {
+        const unsigned long long bit = (1ULL << i);
+
+        switch (block[i]) {
+            case '"': {
+                masks.Quotes |= bit;
+                break;
+            }
+            case '\\': {
+                masks.Backslashes |= bit;
+                break;
+            }
+            case '{':
+            case '}':
+            case '[':
+            case ']':
+            case ',':
+            case ':': {
+                masks.Structurals |= bit;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+#endif
+}
+
+// The bytes that come right after an odd run of backslashes: the escaped ones. Every run is added to its first bit, so the carry
+// lands right after it; starting on an even or an odd bit tells where an odd run ends.
+static inline unsigned long long escapedBytes(const unsigned long long backslashes, Carry &carry) noexcept {
+    static const unsigned long long even_bits = 0x5555555555555555ULL;
+    static const unsigned long long odd_bits  = ~even_bits;
+
+    const unsigned long long starts     = (backslashes & ~(backslashes << 1U));
+    const unsigned long long even_start = (even_bits ^ carry.OddBackslash); // A run that goes on from the last block is as long as both.
+    const unsigned long long even_runs  = (backslashes + (starts & even_start));
+    const unsigned long long odd_runs   = (backslashes + (starts & ~even_start));
+    const unsigned long long odd_ends   = (((even_runs & ~backslashes) & odd_bits) |
+                                         (((odd_runs | carry.OddBackslash) & ~backslashes) & even_bits));
+
+    carry.OddBackslash = ((odd_runs < backslashes) ? 1ULL : 0ULL); // The run reached the last byte.
+
+    return odd_ends;
+}
+
+// Bit i is the XOR of bits 0 to i: from a quote that opens a string to the byte before the one that closes it.
+static inline unsigned long long prefixXOR(unsigned long long bits) noexcept {
+    bits ^= (bits << 1U);
+    bits ^= (bits << 2U);
+    bits ^= (bits << 4U);
+    bits ^= (bits << 8U);
+    bits ^= (bits << 16U);
+    bits ^= (bits << 32U);
+
+    return bits;
+}
+
+// The structural bytes of a block: { } [ ] , : outside of strings, and the quotes that open and close them.
+static inline unsigned long long structurals(const char *block, Carry &carry) noexcept {
+    Masks masks;
+    classify(masks, block);
+
+    const unsigned long long quotes    = (masks.Quotes & ~escapedBytes(masks.Backslashes, carry));
+    const unsigned long long in_string = (prefixXOR(quotes) ^ carry.InString);
+
+    carry.InString = ((in_string >> 63U) != 0) ? ~0ULL : 0ULL;
+
+    return ((masks.Structurals & ~in_string) | quotes);
+}
+
+// Adds the offsets of the structural bytes of content[offset, end) to index, in order, one block of 64 at a time, and returns
+// where it has stopped; the part of a block at the end waits for more, unless it is the last one. A quote that opens a string is
+// always followed by the one that closes it, unless the text ends first.
+static UNumber indexBlocks(Array<UNumber> &index, Carry &carry, const char *content, UNumber offset, const UNumber end,
+                           const bool last) noexcept {
+    char tail[64];
+
+    while (((offset + 64) <= end) || (last && (offset < end))) {
+        const char *block = (content + offset);
+
+        if ((offset + 64) > end) {
+            // The rest, with spaces after it.
+            const UNumber rest = (end - offset);
+            Memory::Copy(tail, block, rest);
+
+            for (UNumber i = rest; i < 64; i++) {
+                tail[i] = ' ';
+            }
+
+            block = tail;
+        }
+
+        unsigned long long bits = structurals(block, carry);
+
+        if ((index.Size + 64) > index.Capacity) {
+            index.Resize((index.Capacity * 2) + 64);
+        }
+
+        UNumber *at = (index.Storage + index.Size);
+
+        while (bits != 0) {
+            *at = (offset + Platform::CTZ(bits));
+            ++at;
+            bits &= (bits - 1);
+        }
+
+        index.Size = static_cast<UNumber>(at - index.Storage);
+        offset += 64;
+    }
+
+    return ((offset < end) ? offset : end);
+}
+
+// The offsets of the structural bytes of content[offset, offset + limit), in order.
+static void Index(Array<UNumber> &index, const char *content, const UNumber offset, const UNumber limit) noexcept {
+    Carry carry;
+    indexBlocks(index, carry, content, offset, (offset + limit), true);
+}
+/////////////////////////////////
+// Read() events; value is a view into the text.
+struct Events {
+    static const UShort OBJECT      = 1;  // {
+    static const UShort END_OBJECT  = 2;  // }
+    static const UShort ARRAY       = 3;  // [
+    static const UShort END_ARRAY   = 4;  // ]
+    static const UShort KEY         = 5;  // What is between the quotes, with its escapes.
+    static const UShort STRING      = 6;  // The same.
+    static const UShort NUMBER      = 7;  // Anything between two separators that is not true, false or null; String::ToNumber() tells.
+    static const UShort TRUE_VALUE  = 8;  // Anything that starts with t,
+    static const UShort FALSE_VALUE = 9;  // f,
+    static const UShort NULL_VALUE  = 10; // or n.
+};
+
+// False stops reading.
+using ReadCB_ = bool(const UShort event, const StringView &value, void *other);
+
+// An object or an array that has not closed yet.
+struct Nest {
+    UNumber ValueAt{0}; // Where a number, true, false or null would start.
+    UNumber KeyAt{0};   // The key of the next value, in an object; it is reported right before that value.
+    UNumber KeyLength{0};
+    bool    Object{false};
+    bool    HasKey{false};
+    bool    HasValue{false}; // A string, an object or an array since the last comma.
+};
+
+// Reads the first object or array of JSON text, from the structural bytes that Index() finds, and reports every object, array,
+// key and value in it to read(), without building anything; what comes before it and after it is left out. A key is reported
+// right before its value, and one without a value is not; in an object, a value without a key comes alone. The text can come
+// in chunks: the views of the events point into Content then, and they are valid until read() returns.
+struct Reader {
+    ReadCB_ *      Read;
+    void *         Other;
+    String         Content{};     // Chunks that are not read yet, from the start of the first value that is not whole.
+    Array<UNumber> Structurals{}; // Their offsets in the text.
+    Array<Nest>    Nests{};
+    Carry          Blocks{};
+    UNumber        Indexed{0}; // Where Index() has stopped in Content.
+    UNumber        Next{0};    // The first structural byte that is not read yet.
+    bool           Closed{false};  // The object or the array has been read to its end.
+    bool           Stopped{false}; // By read().
+
+    explicit Reader(ReadCB_ *read, void *other = nullptr) noexcept : Read(read), Other(other) {
+    }
+
+    // Reads what a chunk completes; false: reading has ended, and the rest of the chunks can go.
+    bool Feed(const char *chunk, const UNumber length) noexcept {
+        if (Closed || Stopped) {
+            return false;
+        }
+
+        drop();
+
+        if (length != 0) {
+            String::Appand(Content, chunk, Content.Length, length);
+        }
+
+        Indexed = indexBlocks(Structurals, Blocks, Content.Str, Indexed, Content.Length, false);
+        walk(Content.Str);
+
+        return !(Closed || Stopped);
+    }
+
+    // The end of the text; true if the object or the array has been read to its end.
+    bool Finish() noexcept {
+        if (!(Closed || Stopped)) {
+            drop();
+            Indexed = indexBlocks(Structurals, Blocks, Content.Str, Indexed, Content.Length, true);
+            walk(Content.Str);
+        }
+
+        return Closed;
+    }
+
+    // Drops what has been read from Content, and moves the offsets down with it.
+    void drop() noexcept {
+        UNumber keep = Indexed;
+
+        if ((Next < Structurals.Size) && (Structurals[Next] < keep)) {
+            keep = Structurals[Next];
+        }
+
+        // A nest that has no value yet may get one from its text: a number, or what is left after an object or an array without a
+        // key, in an object.
+        for (UNumber i = 0; i < Nests.Size; i++) {
+            const Nest &nest = Nests[i];
+
+            if (!nest.HasValue && (nest.ValueAt < keep)) {
+                keep = nest.ValueAt;
+            }
+
+            if (nest.HasKey && (nest.KeyAt < keep)) {
+                keep = nest.KeyAt;
+            }
+        }
+
+        if (keep != 0) {
+            Content.Length -= keep;
+            Memory::Move(Content.Str, (Content.Str + keep), Content.Length);
+            Content.Str[Content.Length] = '\0';
+
+            UNumber i = 0;
+
+            for (; Next < Structurals.Size; Next++) {
+                Structurals[i] = (Structurals[Next] - keep);
+                ++i;
+            }
+
+            Structurals.Size = i;
+            Next             = 0;
+            Indexed -= keep;
+
+            for (i = 0; i < Nests.Size; i++) {
+                Nests[i].ValueAt = ((Nests[i].ValueAt > keep) ? (Nests[i].ValueAt - keep) : 0);
+                Nests[i].KeyAt   = ((Nests[i].KeyAt > keep) ? (Nests[i].KeyAt - keep) : 0);
+            }
+        }
+    }
+
+    inline void report(const UShort event, const char *content, const UNumber offset, const UNumber length) noexcept {
+        if (!Read(event, StringView(content, offset, length), Other)) {
+            Stopped = true;
+        }
+    }
+
+    // A value in the last nest, after its key.
+    void reportValue(const UShort event, const char *content, const UNumber offset, const UNumber length) noexcept {
+        Nest &nest = Nests[(Nests.Size - 1)];
+
+        if (nest.HasKey) {
+            nest.HasKey = false;
+            report(Events::KEY, content, nest.KeyAt, nest.KeyLength);
+        }
+
+        if (!Stopped) {
+            report(event, content, offset, length);
+        }
+    }
+
+    // A number, true, false or null: whatever is between a separator and the one at end, trimmed.
+    void literal(const char *content, const UNumber end) noexcept {
+        UNumber offset = Nests[(Nests.Size - 1)].ValueAt;
+        UNumber length = (end - offset);
+
+        String::SoftTrim(content, offset, length);
+
+        if (length != 0) {
+            switch (content[offset]) {
+                case 't': {
+                    reportValue(Events::TRUE_VALUE, content, offset, length);
+                    break;
+                }
+                case 'f': {
+                    reportValue(Events::FALSE_VALUE, content, offset, length);
+                    break;
+                }
+                case 'n': {
+                    reportValue(Events::NULL_VALUE, content, offset, length);
+                    break;
+                }
+                default:
+                    reportValue(Events::NUMBER, content, offset, length);
+            }
+        }
+    }
+
+    // Reads the structural bytes from Next on, as long as they make whole values.
+    void walk(const char *content) noexcept {
+        const UNumber *index = Structurals.Storage;
+
+        while (!(Closed || Stopped) && (Next < Structurals.Size)) {
+            const UNumber pos = index[Next];
+            const char    c   = content[pos];
+
+            if ((Nests.Size == 0) && (c != '{') && (c != '[')) {
+                ++Next; // Before the object or the array.
+                continue;
+            }
+
+            switch (c) {
+                case '{':
+                case '[': {
+                    const UShort event = ((c == '{') ? Events::OBJECT : Events::ARRAY);
+
+                    if (Nests.Size != 0) {
+                        Nest &parent    = Nests[(Nests.Size - 1)];
+                        parent.HasValue = (parent.HasValue || !parent.Object || parent.HasKey); // Not one without a key.
+                        reportValue(event, content, pos, 1);
+                    } else {
+                        report(event, content, pos, 1);
+                    }
+
+                    Nest &nest   = Nests.Emplace();
+                    nest.ValueAt = (pos + 1);
+                    nest.Object  = (c == '{');
+                    break;
+                }
+                case '"': {
+                    if ((Next + 1) == Structurals.Size) {
+                        return; // The closing quote has not come yet.
+                    }
+
+                    const UNumber length = (index[(Next + 1)] - pos - 1);
+                    Nest &        nest   = Nests[(Nests.Size - 1)];
+                    ++Next;
+
+                    if (nest.Object && !nest.HasKey) {
+                        nest.HasKey    = true;
+                        nest.KeyAt     = (pos + 1);
+                        nest.KeyLength = length;
+                    } else {
+                        nest.HasValue = true;
+                        reportValue(Events::STRING, content, (pos + 1), length);
+                    }
+
+                    break;
+                }
+                case ':': {
+                    Nests[(Nests.Size - 1)].ValueAt = (pos + 1);
+                    break;
+                }
+                case ',': {
+                    if (!Nests[(Nests.Size - 1)].HasValue) {
+                        literal(content, pos);
+                    }
+
+                    Nest &nest    = Nests[(Nests.Size - 1)];
+                    nest.ValueAt  = (pos + 1);
+                    nest.HasKey   = false;
+                    nest.HasValue = false;
+                    break;
+                }
+                default: { // } or ]
+                    if (!Nests[(Nests.Size - 1)].HasValue) {
+                        literal(content, pos);
+                    }
+
+                    const bool object = Nests[(Nests.Size - 1)].Object;
+                    Nests.Remove(Nests.Size - 1);
+
+                    if (!Stopped) {
+                        report((object ? Events::END_OBJECT : Events::END_ARRAY), content, pos, 1);
+                    }
+
+                    Closed = (Nests.Size == 0);
+                }
+            }
+
+            ++Next;
+        }
+    }
+};
+
+// Reads the first object or array of content[offset, offset + limit) with a Reader; true if it has been read to its end.
+static bool Read(const char *content, const UNumber offset, const UNumber limit, ReadCB_ *read, void *other = nullptr) noexcept {
+    Reader reader(read, other);
+    Index(reader.Structurals, content, offset, limit);
+    reader.walk(content);
+
+    return reader.Closed;
+}
+
+} // namespace JSON
+} // namespace Qentem
+
+#endif
@@ -9,6 +9,10 @@
  */
 
 #include "Common.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
 
 #ifndef QENTEM_MEMORY_H
 #define QENTEM_MEMORY_H
@@ -16,27 +20,349 @@
 namespace Qentem {
 namespace Memory {
 
+using AllocateCB_   = void *(UNumber size, void *target);
+using DeallocateCB_ = void(void *block, UNumber size, void *target);
+
+// Where Allocate() gets memory from, instead of new; see AllocatorScope.
+struct Allocator {
+    AllocateCB_ *  Allocate{nullptr};
+    DeallocateCB_ *Deallocate{nullptr};
+    void *         Target{nullptr}; // For the callbacks.
+};
+
+// In front of every allocation: Deallocate() gives the memory back to the allocator that it came from, whatever the current
+// one is by then.
+struct Header {
+    UNumber    Count;
+    Allocator *Owner; // nullptr: new.
+};
+
+// The allocator of the current thread; nullptr: new and delete. It is not static, so every file shares it.
+inline Allocator *&Current() noexcept {
+    static thread_local Allocator *current = nullptr;
+    return current;
+}
+
+// Every allocation of the current thread goes to the allocator until the scope ends; nullptr goes back to new, and the getters
+// of the static expressions do that, so they live as long as the program does.
+struct AllocatorScope {
+    Allocator *Previous;
+
+    explicit AllocatorScope(Allocator *allocator) noexcept : Previous(Current()) {
+        Current() = allocator;
+    }
+
+    AllocatorScope(const AllocatorScope &src) = delete;
+    AllocatorScope &operator=(const AllocatorScope &src) = delete;
+
+    ~AllocatorScope() noexcept {
+        Current() = Previous;
+    }
+};
+
+// What an allocation is for, in the counts of QENTEM_MEMORY_STATS: the items of a type count as one kind, and headers say which
+// by specializing KindOf, like Relocatable. The rest are items of arrays.
+enum Kind { StringK = 0, ArrayK = 1, DocumentK = 2, MatchK = 3 };
+
+template <typename Type>
+struct KindOf {
+    static const Kind Value = ArrayK;
+};
+
+template <>
+struct KindOf<char> {
+    static const Kind Value = StringK;
+};
+
+#if defined(QENTEM_MEMORY_STATS)
+// For one kind or for all of them: every Reserve() and Release() of the thread, whatever allocator serves it, headers included.
+struct Counts {
+    UNumber Allocations{0};
+    UNumber Frees{0};
+    UNumber Bytes{0};     // Allocated, and not freed yet.
+    UNumber PeakBytes{0}; // The most that Bytes has been since ResetStats().
+};
+
+struct Stats {
+    static const UShort Kinds = 4;
+
+    Counts ByKind[Kinds]{};
+    Counts Total{};
+};
+
+// The counts of the current thread; memory that another thread frees comes off that thread's counts.
+inline Stats &GetStats() noexcept {
+    static thread_local Stats stats;
+    return stats;
+}
+
+// Starts the counts over. What is still allocated stays in Bytes, and the peaks start from there.
+inline void ResetStats() noexcept {
+    Stats &stats = GetStats();
+
+    for (UShort i = 0; i <= Stats::Kinds; i++) {
+        Counts &counts     = ((i != Stats::Kinds) ? stats.ByKind[i] : stats.Total);
+        counts.Allocations = 0;
+        counts.Frees       = 0;
+        counts.PeakBytes   = counts.Bytes;
+    }
+}
+
+static inline void countAllocation(Counts &counts, const UNumber bytes) noexcept {
+    ++counts.Allocations;
+    counts.Bytes += bytes;
+
+    if (counts.Bytes > counts.PeakBytes) {
+        counts.PeakBytes = counts.Bytes;
+    }
+}
+
+static inline void countFree(Counts &counts, const UNumber bytes) noexcept {
+    ++counts.Frees;
+    counts.Bytes -= ((bytes < counts.Bytes) ? bytes : counts.Bytes);
+}
+#endif
+
+// Memory for size items, that are not constructed; for containers that construct their own items.
+template <typename Type>
+static inline void Reserve(Type **pinter, const UNumber size) noexcept {
+    if (size > ((~UNumber{0} - sizeof(Header)) / sizeof(Type))) {
+        std::abort(); // The bytes would wrap around to a block that is too small for them.
+    }
+
+    Allocator *   owner = Current();
+    const UNumber bytes = (sizeof(Header) + (size * sizeof(Type)));
+    Header *      header;
+
+    if (owner == nullptr) {
+        header = static_cast<Header *>(::operator new(bytes));
+    } else {
+        header = static_cast<Header *>(owner->Allocate(bytes, owner->Target));
+    }
+
+    header->Count = size;
+    header->Owner = owner;
+
+#if defined(QENTEM_MEMORY_STATS)
+    countAllocation(GetStats().ByKind[KindOf<Type>::Value], bytes);
+    countAllocation(GetStats().Total, bytes);
+#endif
+
+    *pinter = reinterpret_cast<Type *>(header + 1);
+}
+
+// Frees what Reserve() gives, without destroying anything.
+template <typename Type>
+static inline void Release(Type **pinter) noexcept {
+    if (*pinter != nullptr) {
+        Header *header = (reinterpret_cast<Header *>(*pinter) - 1);
+
+#if defined(QENTEM_MEMORY_STATS)
+        const UNumber bytes = (sizeof(Header) + (header->Count * sizeof(Type)));
+        countFree(GetStats().ByKind[KindOf<Type>::Value], bytes);
+        countFree(GetStats().Total, bytes);
+#endif
+
+        if (header->Owner == nullptr) {
+            ::operator delete(header);
+        } else {
+            header->Owner->Deallocate(header, (sizeof(Header) + (header->Count * sizeof(Type))), header->Owner->Target);
+        }
+
+        *pinter = nullptr;
+    }
+}
+
 template <typename Type>
 static inline void Allocate(Type **pinter, const UNumber size) noexcept {
-    *pinter = new Type[size];
+    Reserve<Type>(pinter, size);
+
+    for (UNumber i = 0; i < size; i++) {
+        new (*pinter + i) Type;
+    }
 }
 
 template <typename Type>
 static inline void Deallocate(Type **pinter) noexcept {
-    delete[] * pinter;
-    *pinter = nullptr;
+    Type *storage = *pinter;
+
+    if (storage != nullptr) {
+        for (UNumber i = (reinterpret_cast<Header *>(storage) - 1)->Count; i != 0;) {
+            storage[--i].~Type();
+        }
+
+        Release<Type>(pinter);
+    }
 }
 
 template <typename Type>
 static inline void AllocateBit(Type **pinter) noexcept {
-    *pinter = new Type;
+    Allocate<Type>(pinter, 1);
 }
 
 template <typename Type>
 static inline void DeallocateBit(Type **pinter) noexcept {
-    delete *pinter;
-    *pinter = nullptr;
+    Deallocate<Type>(pinter);
+}
+/////////////////////////////////
+// Whether a Type can move by copying its bytes, and forgetting the old ones without destroying them: Array moves such items
+// with memcpy. Types that hold no pointer into themselves say so by specializing it.
+template <typename Type>
+struct Relocatable {
+    static const bool Value = std::is_trivially_copyable<Type>::value;
+};
+
+inline static void Copy(void *to, const void *from, const UNumber size) noexcept {
+    std::memcpy(to, from, size);
+}
+
+// Like Copy(), for places that overlap.
+inline static void Move(void *to, const void *from, const UNumber size) noexcept {
+    std::memmove(to, from, size);
+}
+
+// Whether the size bytes at left and at right are the same.
+inline static bool Compare(const void *left, const void *right, const UNumber size) noexcept {
+    return ((size == 0) || (std::memcmp(left, right, size) == 0));
 }
+/////////////////////////////////
+// A chunk of an Arena or a Pool.
+struct Chunk {
+    Chunk * Next;
+    UNumber Size;
+};
+
+// Hands out memory from big chunks, and frees nothing until Reset(): for the objects of one render or one parse, that all go
+// away together. Everything that has been allocated from it has to be gone by the time it resets.
+struct Arena : Allocator {
+    Chunk * Chunks{nullptr}; // The newest first.
+    char *  Next{nullptr};
+    UNumber Room{0};
+    UNumber ChunkSize;
+
+    explicit Arena(const UNumber chunkSize = 65536) noexcept : ChunkSize(chunkSize) {
+        Allocate   = &(arenaAllocate);
+        Deallocate = &(arenaDeallocate);
+        Target     = this;
+    }
+
+    Arena(const Arena &src) = delete;
+    Arena &operator=(const Arena &src) = delete;
+
+    ~Arena() noexcept {
+        while (Chunks != nullptr) {
+            Chunk *chunk = Chunks;
+            Chunks       = chunk->Next;
+            ::operator delete(chunk);
+        }
+    }
+
+    // Frees every chunk but the newest, which is the biggest, and starts over in it.
+    void Reset() noexcept {
+        if (Chunks != nullptr) {
+            while (Chunks->Next != nullptr) {
+                Chunk *chunk = Chunks->Next;
+                Chunks->Next = chunk->Next;
+                ::operator delete(chunk);
+            }
+
+            Next = reinterpret_cast<char *>(Chunks + 1);
+            Room = Chunks->Size;
+        }
+    }
+
+    static void *arenaAllocate(UNumber size, void *target) noexcept {
+        Arena *arena = static_cast<Arena *>(target);
+        size         = ((size + 15) & ~static_cast<UNumber>(15));
+
+        if (size > arena->Room) {
+            // Every new chunk is twice the last one.
+            UNumber chunk_size = ((arena->Chunks != nullptr) ? (arena->Chunks->Size * 2) : arena->ChunkSize);
+
+            if (chunk_size < size) {
+                chunk_size = size;
+            }
+
+            Chunk *chunk  = static_cast<Chunk *>(::operator new(sizeof(Chunk) + chunk_size));
+            chunk->Next   = arena->Chunks;
+            chunk->Size   = chunk_size;
+            arena->Chunks = chunk;
+            arena->Next   = reinterpret_cast<char *>(chunk + 1);
+            arena->Room   = chunk_size;
+        }
+
+        void *block = arena->Next;
+        arena->Next += size;
+        arena->Room -= size;
+
+        return block;
+    }
+
+    static void arenaDeallocate(void *block, UNumber size, void *target) noexcept {
+    }
+};
+/////////////////////////////////
+// Keeps freed blocks of up to 4 KB in lists by size (powers of 2), and hands them out again; bigger ones go to new and delete.
+// It keeps its memory until it is destroyed, so it suits work that allocates and frees the same sizes over and over.
+struct Pool : Allocator {
+    static const UShort Classes = 9; // 16 to 4096 bytes.
+
+    void * Free[Classes]{};
+    Arena  Blocks{};
+
+    Pool() noexcept {
+        Allocate   = &(poolAllocate);
+        Deallocate = &(poolDeallocate);
+        Target     = this;
+    }
+
+    Pool(const Pool &src) = delete;
+    Pool &operator=(const Pool &src) = delete;
+
+    // The index of the smallest class that size fits in; Classes: none.
+    static UShort getClass(const UNumber size) noexcept {
+        UShort  id    = 0;
+        UNumber bytes = 16;
+
+        while ((bytes < size) && (id < Classes)) {
+            bytes <<= 1;
+            ++id;
+        }
+
+        return id;
+    }
+
+    static void *poolAllocate(const UNumber size, void *target) noexcept {
+        Pool *       pool = static_cast<Pool *>(target);
+        const UShort id   = getClass(size);
+
+        if (id == Classes) {
+            return ::operator new(size);
+        }
+
+        void *block = pool->Free[id];
+
+        if (block != nullptr) {
+            pool->Free[id] = *(static_cast<void **>(block));
+            return block;
+        }
+
+        return Arena::arenaAllocate((static_cast<UNumber>(16) << id), &(pool->Blocks));
+    }
+
+    static void poolDeallocate(void *block, const UNumber size, void *target) noexcept {
+        Pool *       pool = static_cast<Pool *>(target);
+        const UShort id   = getClass(size);
+
+        if (id == Classes) {
+            ::operator delete(block);
+            return;
+        }
+
+        *(static_cast<void **>(block)) = pool->Free[id];
+        pool->Free[id]                 = block;
+    }
+};
 
 } // namespace Memory
 } // namespace Qentem
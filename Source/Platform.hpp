@@ -0,0 +1,129 @@
+/**
+ * Qentem Platform
+ *
+ * @brief     Compiler and instruction set detection for Qentem.
+ *
+ * @author    Hani Ammar <hani.code@outlook.com>
+ * @copyright 2019 Hani Ammar
+ * @license   https://opensource.org/licenses/MIT
+ */
+
+#include "Common.hpp"
+
+#ifndef QENTEM_PLATFORM_H
+#define QENTEM_PLATFORM_H
+
+// Define QENTEM_NO_SIMD to build the scalar code only.
+#ifndef QENTEM_NO_SIMD
+
+#if defined(__AVX2__)
+#define QENTEM_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define QENTEM_SSE2 1
+#endif
+
+#endif
+
+// Reading bytes as words: the digit parser of Digit.hpp reads eight at a time on little endian machines only.
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define QENTEM_BIG_ENDIAN 1
+#endif
+
+// writev() and file descriptors.
+#if defined(__unix__) || defined(__APPLE__)
+#define QENTEM_POSIX 1
+#endif
+
+#if defined(QENTEM_AVX2)
+#include <immintrin.h>
+#elif defined(QENTEM_SSE2)
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Qentem {
+namespace Platform {
+
+// Index of the lowest set bit; value must not be zero.
+static inline UNumber CTZ(unsigned int value) noexcept {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return static_cast<UNumber>(index);
+#else
+    return static_cast<UNumber>(__builtin_ctz(value));
+#endif
+}
+
+static inline UNumber CTZ(unsigned long long value) noexcept {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<UNumber>(index);
+#elif defined(_MSC_VER)
+    unsigned long index;
+
+    if (static_cast<unsigned int>(value) != 0) {
+        _BitScanForward(&index, static_cast<unsigned long>(value));
+        return static_cast<UNumber>(index);
+    }
+
+    _BitScanForward(&index, static_cast<unsigned long>(value >> 32U));
+    return static_cast<UNumber>(index + 32);
+#else
+    return static_cast<UNumber>(__builtin_ctzll(value));
+#endif
+}
+
+// Count of the zero bits above the highest set one; value must not be zero.
+static inline UShort CLZ(unsigned long long value) noexcept {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<UShort>(63 - index);
+#elif defined(_MSC_VER)
+    unsigned long index;
+
+    if ((value >> 32U) != 0) {
+        _BitScanReverse(&index, static_cast<unsigned long>(value >> 32U));
+        return static_cast<UShort>(31 - index);
+    }
+
+    _BitScanReverse(&index, static_cast<unsigned long>(value));
+    return static_cast<UShort>(63 - index);
+#else
+    return static_cast<UShort>(__builtin_clzll(value));
+#endif
+}
+
+// The full 128-bit product of low and high: the low half goes back into low, and the high half into high.
+static inline void Multiply(unsigned long long &low, unsigned long long &high) noexcept {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 UInt128_;
+
+    const UInt128_ product = (static_cast<UInt128_>(low) * high);
+    low                    = static_cast<unsigned long long>(product);
+    high                   = static_cast<unsigned long long>(product >> 64U);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    low = _umul128(low, high, &high);
+#else
+    const unsigned long long lo_lo = ((low & 0xFFFFFFFFULL) * (high & 0xFFFFFFFFULL));
+    const unsigned long long hi_lo = ((low >> 32U) * (high & 0xFFFFFFFFULL));
+    const unsigned long long lo_hi = ((low & 0xFFFFFFFFULL) * (high >> 32U));
+    const unsigned long long hi_hi = ((low >> 32U) * (high >> 32U));
+    const unsigned long long cross = ((lo_lo >> 32U) + (hi_lo & 0xFFFFFFFFULL) + lo_hi);
+
+    low  = ((cross << 32U) | (lo_lo & 0xFFFFFFFFULL));
+    high = (hi_hi + (hi_lo >> 32U) + (cross >> 32U));
+#endif
+}
+
+} // namespace Platform
+} // namespace Qentem
+
+#endif
@@ -0,0 +1,161 @@
+/**
+ * Qentem Sink
+ *
+ * @brief     An output buffer for rendering into.
+ *
+ * @author    Hani Ammar <hani.code@outlook.com>
+ * @copyright 2019 Hani Ammar
+ * @license   https://opensource.org/licenses/MIT
+ */
+
+#include "String.hpp"
+
+#ifndef QENTEM_SINK_H
+#define QENTEM_SINK_H
+
+namespace Qentem {
+
+using SinkWriter_ = void(const char *str, const UNumber length, void *target);
+
+// Where rendered content goes. By default it is a buffer that grows; it can also fill a fixed buffer that belongs to the caller,
+// or pass its content to a writer (a file descriptor, a socket...) every time it fills up.
+struct Sink {
+    UNumber      Length{0};
+    char *       Str{nullptr}; // NULL terminated, unless there is a writer.
+    UNumber      Capacity{0};
+    SinkWriter_ *Writer{nullptr}; // Gets the content when the buffer is full, and on Flush().
+    void *       Target{nullptr}; // For the writer.
+    UNumber      Written{0};      // What has been passed to the writer so far.
+    bool         Fixed{false};    // The buffer belongs to the caller, and it does not grow.
+    bool         Overflow{false}; // A fixed buffer was too small, and the content has been cut.
+
+    Sink() = default;
+
+    explicit Sink(const UNumber capacity) noexcept : Capacity(capacity) {
+        Memory::Allocate<char>(&Str, (Capacity + 1));
+        Str[0] = '\0';
+    }
+
+    // A fixed buffer: it holds (size - 1) characters and the NULL. One of no size is not touched, and overflows right away.
+    Sink(char *buffer, const UNumber size) noexcept : Fixed(true) {
+        if (size != 0) {
+            Str      = buffer;
+            Capacity = (size - 1);
+            Str[0]   = '\0';
+        } else {
+            Overflow = true;
+        }
+    }
+
+    Sink(SinkWriter_ *writer, void *target, const UNumber capacity = 4096) noexcept : Capacity(capacity), Writer(writer), Target(target) {
+        Memory::Allocate<char>(&Str, (Capacity + 1));
+    }
+
+    Sink(const Sink &src) = delete;
+    Sink &operator=(const Sink &src) = delete;
+
+    ~Sink() noexcept {
+        Flush();
+
+        if (!Fixed) {
+            Memory::Deallocate<char>(&Str);
+        }
+    }
+
+    void Add(const char *str, const UNumber length) noexcept {
+        if (length == 0) {
+            return;
+        }
+
+        if ((Length + length) > Capacity) {
+            if (Writer != nullptr) {
+                Flush();
+
+                if (length >= Capacity) {
+                    Writer(str, length, Target);
+                    Written += length;
+                    return;
+                }
+            } else if (Fixed) {
+                Overflow = true;
+
+                if (Str != nullptr) {
+                    Memory::Copy(&(Str[Length]), str, (Capacity - Length));
+                    Length      = Capacity;
+                    Str[Length] = '\0';
+                }
+
+                return;
+            } else {
+                Capacity *= 2;
+
+                if (Capacity < (Length + length)) {
+                    Capacity = (Length + length);
+                }
+
+                char *tmp = Str;
+                Memory::Allocate<char>(&Str, (Capacity + 1));
+
+                if (Length != 0) {
+                    Memory::Copy(Str, tmp, Length);
+                }
+
+                Memory::Deallocate<char>(&tmp);
+            }
+        }
+
+        Memory::Copy(&(Str[Length]), str, length);
+        Length += length;
+
+        if (Writer == nullptr) {
+            Str[Length] = '\0';
+        }
+    }
+
+    inline void operator+=(const char *str) noexcept {
+        if (str != nullptr) {
+            Add(str, String::Count(str));
+        }
+    }
+
+    inline void operator+=(const String &src) noexcept {
+        Add(src.Str, src.Length);
+    }
+
+    inline void operator+=(const StringView &src) noexcept {
+        Add(src.Str, src.Length);
+    }
+
+    // Passes the buffer to the writer.
+    void Flush() noexcept {
+        if ((Writer != nullptr) && (Length != 0)) {
+            Writer(Str, Length, Target);
+            Written += Length;
+            Length = 0;
+        }
+    }
+
+    // The content as a String: a growing buffer is handed over without copying.
+    String ToString() noexcept {
+        String str;
+
+        if (Fixed || (Writer != nullptr) || (Str == nullptr)) {
+            String::Appand(str, Str, 0, Length);
+            return str;
+        }
+
+        str.Str      = Str;
+        str.Length   = Length;
+        str.Capacity = Capacity;
+
+        Str      = nullptr;
+        Length   = 0;
+        Capacity = 0;
+
+        return str;
+    }
+};
+
+} // namespace Qentem
+
+#endif
@@ -8,90 +8,173 @@
  * @license   https://opensource.org/licenses/MIT
  */
 
+#include "Digit.hpp"
 #include "Memory.hpp"
+#include "Platform.hpp"
+#include <cstring>
 
 #ifndef QENTEM_STRING_H
 #define QENTEM_STRING_H
 
 namespace Qentem {
 
+// Part of a string that it does not own: it is not NULL terminated, and what it points to has to outlive it.
+struct StringView {
+    const char *Str{nullptr};
+    UNumber     Length{0};
+
+    StringView() = default;
+
+    StringView(const char *str, const UNumber length) noexcept : Str(str), Length(length) {
+    }
+
+    StringView(const char *str, const UNumber offset, const UNumber length) noexcept : Str(&(str[offset])), Length(length) {
+    }
+};
+
+// A short string is kept inside the object, in Local, and Str points to it; so it is not Memory::Relocatable.
 struct String {
     UNumber Length{0};
     char *  Str{nullptr}; // NULL terminated char
     UNumber Capacity{0};
+    char    Local[16];
 
     explicit String() = default;
 
-    explicit String(const UNumber capacity) noexcept : Capacity(capacity) {
-        Memory::Allocate<char>(&Str, (Capacity + 1));
+    explicit String(const UNumber capacity) noexcept {
+        allocate(capacity);
+    }
+
+    explicit String(const char *str, const UNumber capacity) noexcept {
+        allocate(capacity);
+        copy(str, capacity);
+    }
+
+    String(const char *str) noexcept {
+        allocate(Count(str));
+        copy(str, Capacity);
     }
 
-    explicit String(const char *str, const UNumber capacity) noexcept : Capacity(capacity) {
-        Memory::Allocate<char>(&Str, (Capacity + 1));
+    // The first length characters of str, with room for capacity.
+    explicit String(const char *str, const UNumber length, const UNumber capacity) noexcept {
+        allocate(capacity);
+        copy(str, length);
+    }
+
+    explicit String(const StringView &view) noexcept : String(view.Str, view.Length) {
+    }
 
-        while (Length < Capacity) {
-            Str[Length] = str[Length];
-            ++Length;
+    String(String &&src) noexcept {
+        take(src);
+    }
+
+    explicit String(const String &src) noexcept {
+        if (src.Length != 0) {
+            allocate(src.Length);
+            copy(src.Str, src.Length);
         }
+    }
 
-        Str[Length] = '\0';
+    ~String() noexcept {
+        deallocate();
     }
 
-    String(const char *str) noexcept : Capacity(Count(str)) {
-        Memory::Allocate<char>(&Str, (Capacity + 1));
+    // Points Str at room for capacity characters and the NULL; it does not keep what Str has.
+    inline void allocate(const UNumber capacity) noexcept {
+        Capacity = capacity;
 
-        while (Length < Capacity) {
-            Str[Length] = str[Length];
-            ++Length;
+        if (capacity < sizeof(Local)) {
+            Str = Local;
+        } else {
+            Memory::Allocate<char>(&Str, (capacity + 1));
         }
+    }
 
-        Str[Length] = '\0';
+    inline void deallocate() noexcept {
+        if (Str != Local) {
+            Memory::Deallocate<char>(&Str);
+        } else {
+            Str = nullptr;
+        }
     }
 
-    String(String &&src) noexcept : Length(src.Length), Str(src.Str), Capacity(src.Capacity) {
-        src.Length   = 0;
-        src.Str      = nullptr;
-        src.Capacity = 0;
+    // Sets the content to length characters of str; there has to be room for them.
+    inline void copy(const char *str, const UNumber length) noexcept {
+        if (length != 0) {
+            Memory::Move(Str, str, length); // str can be part of this string.
+        }
+
+        Length      = length;
+        Str[Length] = '\0';
     }
 
-    explicit String(const String &src) noexcept : Capacity(src.Length) {
-        if (Capacity != 0) {
-            Memory::Allocate<char>(&Str, (Capacity + 1));
+    // Makes room for capacity characters, and keeps the content.
+    void grow(const UNumber capacity) noexcept {
+        char *tmp = Str;
+        allocate(capacity);
 
-            for (; Length < Capacity;) {
-                Str[Length] = src[Length];
-                ++Length;
+        if (Str != tmp) {
+            if (Length != 0) {
+                Memory::Copy(Str, tmp, Length);
             }
 
-            Str[Length] = '\0';
+            if (tmp != Local) {
+                Memory::Deallocate<char>(&tmp);
+            }
         }
+
+        Str[Length] = '\0';
     }
 
-    ~String() noexcept {
-        Memory::Deallocate<char>(&Str);
+    // Moves the content of src here, and leaves it empty; Str has to be free.
+    inline void take(String &src) noexcept {
+        Length   = src.Length;
+        Capacity = src.Capacity;
+
+        if (src.Str == src.Local) {
+            Str = Local;
+
+            for (UNumber i = 0; i <= Length; i++) {
+                Local[i] = src.Local[i];
+            }
+        } else {
+            Str = src.Str;
+        }
+
+        src.Length   = 0;
+        src.Str      = nullptr;
+        src.Capacity = 0;
     }
 
-    static UNumber Count(const char *str) noexcept {
-        UNumber length = 0;
-        while (str[length] != '\0') {
-            ++length;
-        };
+    inline StringView View() const noexcept {
+        return StringView(Str, Length);
+    }
 
-        return length;
+    // Count() and the compares go to strlen(), strcmp() and memcmp(): the C library picks the widest vectors that the CPU has,
+    // at run time. Hand written SSE2 loops were no faster on long values, and slower on short keys.
+    inline static UNumber Count(const char *str) noexcept {
+        return static_cast<UNumber>(std::strlen(str));
     }
 
     void Reset() noexcept {
-        Memory::Deallocate<char>(&Str);
+        deallocate();
 
         Length   = 0;
         Capacity = 0;
     }
 
+    // The buffer is the caller's now; Memory::Deallocate() frees it, not delete. A short string is copied out of the object.
     char *Eject() noexcept {
         char *str = Str;
-        Str       = nullptr;
-        Length    = 0;
-        Capacity  = 0;
+
+        if (Str == Local) {
+            Memory::Allocate<char>(&str, (Length + 1));
+            Memory::Copy(str, Local, (Length + 1));
+        }
+
+        Str      = nullptr;
+        Length   = 0;
+        Capacity = 0;
 
         return str;
     }
@@ -100,18 +183,11 @@ struct String {
         const UNumber length = Count(str);
 
         if ((Capacity == 0) || (Capacity < length)) {
-            Memory::Deallocate<char>(&Str);
-            Length   = 0;
-            Capacity = length;
-            Memory::Allocate<char>(&Str, (Capacity + 1));
+            deallocate();
+            allocate(length);
         }
 
-        while (Length < Capacity) {
-            Str[Length] = str[Length];
-            ++Length;
-        }
-
-        Str[Length] = '\0';
+        copy(str, length);
 
         return *this;
     }
@@ -119,18 +195,11 @@ struct String {
     String &operator=(const String &src) noexcept {
         if (this != &src) {
             if ((Capacity == 0) || (Capacity < src.Length)) {
-                Memory::Deallocate<char>(&Str);
-                Length   = 0;
-                Capacity = src.Length;
-                Memory::Allocate<char>(&Str, (Capacity + 1));
+                deallocate();
+                allocate(src.Length);
             }
 
-            while (Length < Capacity) {
-                Str[Length] = src[Length];
-                ++Length;
-            }
-
-            Str[Length] = '\0';
+            copy(src.Str, src.Length);
         }
 
         return *this;
@@ -138,16 +207,8 @@ struct String {
 
     String &operator=(String &&src) noexcept {
         if (this != &src) {
-            if (Str != nullptr) {
-                Memory::Deallocate<char>(&Str);
-            }
-
-            Length       = src.Length;
-            src.Length   = 0;
-            Str          = src.Str;
-            src.Str      = nullptr;
-            Capacity     = src.Capacity;
-            src.Capacity = 0;
+            deallocate();
+            take(src);
         }
 
         return *this;
@@ -163,10 +224,9 @@ struct String {
         if (src.Length != 0) {
             Appand(*this, src.Str, Length, src.Length);
 
-            Memory::Deallocate<char>(&src.Str);
+            src.deallocate();
 
             src.Length   = 0;
-            src.Str      = nullptr;
             src.Capacity = 0;
         }
 
@@ -181,81 +241,43 @@ struct String {
         return *this;
     }
 
-    String operator+(const char *str) const noexcept {
-        const UNumber length = Count(str);
-
-        String  ns(Length + length);
-        UNumber i = 0;
-
-        for (; i < Length; i++) {
-            ns[i] = Str[i];
+    String &operator+=(const StringView &src) noexcept {
+        if (src.Length != 0) {
+            Appand(*this, src.Str, Length, src.Length);
         }
-        ns.Length = Length;
 
-        for (i = 0; i < length; i++) {
-            ns[ns.Length] = str[i];
-            ++ns.Length;
-        }
+        return *this;
+    }
 
-        ns[ns.Length] = '\0';
+    String operator+(const char *str) const noexcept {
+        const UNumber length = Count(str);
+
+        String ns(Str, Length, (Length + length));
+        Appand(ns, str, ns.Length, length);
 
         return ns;
     }
 
     String operator+(String &&src) const noexcept {
-        String  ns(Length + src.Length);
-        UNumber i = 0;
-
-        for (; i < Length; i++) {
-            ns[i] = Str[i];
-        }
-        ns.Length = Length;
-
-        for (i = 0; i < src.Length; i++) {
-            ns[ns.Length] = src.Str[i];
-            ++ns.Length;
-        }
+        String ns(Str, Length, (Length + src.Length));
+        Appand(ns, src.Str, ns.Length, src.Length);
 
-        ns[ns.Length] = '\0';
-
-        Memory::Deallocate<char>(&src.Str);
+        src.deallocate();
+        src.Length   = 0;
         src.Capacity = 0;
 
         return ns;
     }
 
     String operator+(const String &src) const noexcept {
-        String  ns(Length + src.Length);
-        UNumber i = 0;
-
-        for (; i < Length; i++) {
-            ns[i] = Str[i];
-        }
-        ns.Length = Length;
-
-        for (i = 0; i < src.Length; i++) {
-            ns[ns.Length] = src.Str[i];
-            ++ns.Length;
-        }
-
-        ns[ns.Length] = '\0';
+        String ns(Str, Length, (Length + src.Length));
+        Appand(ns, src.Str, ns.Length, src.Length);
 
         return ns;
     }
 
     bool operator==(const char *str) const noexcept {
-        const UNumber length = Count(str);
-
-        if (Length != length) {
-            return false;
-        }
-
-        UNumber i = 0;
-        while ((i < Length) && (Str[i] == str[i])) {
-            ++i;
-        }
-
-        return (i == Length);
+        return ((Length == Count(str)) && Memory::Compare(Str, str, Length));
     }
 
     inline bool operator!=(const char *string) const noexcept {
@@ -263,149 +285,195 @@ struct String {
     }
 
     bool operator==(const String &string) const noexcept {
-        if (Length != string.Length) {
-            return false;
-        }
-
-        UNumber i = 0;
-        while ((i < Length) && (Str[i] == string[i])) {
-            ++i;
-        }
-
-        return (i == Length);
+        return ((Length == string.Length) && Memory::Compare(Str, string.Str, Length));
     }
 
     inline bool operator!=(const String &string) const noexcept {
         return (!(*this == string));
     }
 
+    inline bool operator==(const StringView &view) const noexcept {
+        return Compare(View(), view);
+    }
+
+    inline bool operator!=(const StringView &view) const noexcept {
+        return (!Compare(View(), view));
+    }
+
     inline char &operator[](const UNumber index) const noexcept {
         return Str[index];
     }
 
     static bool Compare(const char *left, const char *right) noexcept {
-        const UNumber l_length = Count(left);
-        const UNumber r_length = Count(right);
-
-        if (r_length != l_length) {
-            return false;
-        }
-
-        UNumber i = 0;
-        while ((i < r_length) && (left[i] == right[i])) {
-            ++i;
-        }
-
-        return (i == r_length);
+        return (std::strcmp(left, right) == 0);
     }
 
     static bool Compare(const char *src_text, UNumber src_index, const UNumber src_length, const char *des_text, UNumber des_index,
                         const UNumber des_length) noexcept {
-        if (src_length != des_length) {
-            return false;
-        }
-
-        UNumber i = 0;
-        while ((i < src_length) && (src_text[src_index++] == des_text[des_index++])) {
-            ++i; // Only increment when there is a match
-        }
+        return ((src_length == des_length) && Memory::Compare((src_text + src_index), (des_text + des_index), src_length));
+    }
 
-        return (i == src_length);
+    static bool Compare(const StringView &left, const StringView &right) noexcept {
+        return Compare(left.Str, 0, left.Length, right.Str, 0, right.Length);
     }
 
     bool Compare(const String &text, UNumber index, const UNumber length) const noexcept {
-        if (Length != length) {
-            return false;
-        }
-
-        UNumber i = 0;
-        while ((i < length) && (Str[i] == text[index])) {
-            ++i; // Only increment when there is a match
-            ++index;
-        }
-
-        return (i == Length);
+        return ((Length == length) && Memory::Compare(Str, (text.Str + index), length));
     }
 
     static void Appand(String &des, const char *src_p, UNumber start_at, const UNumber ln) noexcept {
-        UNumber i = 0;
-
         const UNumber newlen = (ln + des.Length);
 
         if ((des.Capacity < newlen) || (des.Capacity == 0)) {
-            // Copy any existing characters
-            des.Capacity = newlen;
+            // At least twice the old capacity, so appending over and over is not quadratic; an empty string gets what it needs.
+            UNumber capacity = (des.Capacity * 2);
 
-            char *tmp = des.Str;
-            Memory::Allocate<char>(&des.Str, (des.Capacity + 1));
-
-            while (i < des.Length) {
-                des[i] = tmp[i];
-                ++i;
+            if (capacity < newlen) {
+                capacity = newlen;
             }
 
-            Memory::Deallocate<char>(&tmp);
+            des.grow(capacity);
         }
 
-        // Add characters
-        for (i = 0; i < ln; i++) {
-            des[start_at++] = src_p[i];
+        if (ln != 0) {
+            Memory::Copy(&(des.Str[start_at]), src_p, ln);
         }
 
-        des[start_at] = '\0'; // Null ending.
-        des.Length    = newlen;
+        des[(start_at + ln)] = '\0'; // Null ending.
+        des.Length           = newlen;
     }
 
-    void SetLength(const UNumber size) noexcept {
-        Capacity = size;
+    // Makes room for size characters, so the appends up to that size allocate nothing.
+    void Reserve(const UNumber size) noexcept {
+        if ((size > Capacity) || (Str == nullptr)) {
+            grow(size);
+        }
+    }
 
-        if (Length != 0) {
-            Length = 0;
-            Memory::Deallocate<char>(&Str);
+    // Gives back the room that the content does not use.
+    void ShrinkToFit() noexcept {
+        if ((Str != nullptr) && (Str != Local) && (Capacity != Length)) {
+            char *tmp = Str;
+            allocate(Length);
+            Memory::Copy(Str, tmp, (Length + 1));
+            Memory::Deallocate<char>(&tmp);
         }
+    }
 
-        Memory::Allocate<char>(&Str, (size + 1));
+    void SetLength(const UNumber size) noexcept {
+        deallocate();
+        Length = 0;
+        allocate(size);
 
         Str[0] = '\0';
     }
 
     static String Part(const char *str, UNumber offset, const UNumber limit) noexcept {
-        String s_part(limit);
+        return String(&(str[offset]), limit);
+    }
+
+    // wyhash (final version 4, by Wang Yi), with a seed of zero: every bit of the key moves about half of the bits of the hash.
+    // It is never 0, which marks an empty slot in the tables of Document.
+    static UNumber Hash(const char *str, const UNumber offset, const UNumber limit) noexcept {
+        static const unsigned long long secret[4] = {0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL,
+                                                     0x4d5a2da51de1aa47ULL};
+
+        const unsigned char *key    = reinterpret_cast<const unsigned char *>(str + offset);
+        unsigned long long   seed   = hashMix(secret[0], secret[1]);
+        unsigned long long   a      = 0;
+        unsigned long long   b      = 0;
+        UNumber              length = limit;
+
+        if (length <= 16) {
+            if (length >= 4) {
+                const UNumber step = ((length >> 3U) << 2U);
+
+                a = ((read4(key) << 32U) | read4(key + step));
+                b = ((read4(key + length - 4) << 32U) | read4(key + length - 4 - step));
+            } else if (length != 0) {
+                a = ((static_cast<unsigned long long>(key[0]) << 16U) | (static_cast<unsigned long long>(key[(length >> 1U)]) << 8U) |
+                     key[(length - 1)]);
+            }
+        } else {
+            if (length > 48) {
+                unsigned long long see1 = seed;
+                unsigned long long see2 = seed;
+
+                do {
+                    seed = hashMix((read8(key) ^ secret[1]), (read8(key + 8) ^ seed));
+                    see1 = hashMix((read8(key + 16) ^ secret[2]), (read8(key + 24) ^ see1));
+                    see2 = hashMix((read8(key + 32) ^ secret[3]), (read8(key + 40) ^ see2));
+                    key += 48;
+                    length -= 48;
+                } while (length > 48);
+
+                seed ^= (see1 ^ see2);
+            }
+
+            while (length > 16) {
+                seed = hashMix((read8(key) ^ secret[1]), (read8(key + 8) ^ seed));
+                key += 16;
+                length -= 16;
+            }
 
-        while (s_part.Length != limit) {
-            s_part[s_part.Length++] = str[offset++];
+            a = read8(key + length - 16);
+            b = read8(key + length - 8);
         }
 
-        s_part[s_part.Length] = '\0'; // To mark the end of a string.
+        a ^= secret[1];
+        b ^= seed;
+        Platform::Multiply(a, b);
 
-        return s_part;
+        const UNumber hash = static_cast<UNumber>(hashMix((a ^ secret[0] ^ limit), (b ^ secret[1])));
+
+        return ((hash != 0) ? hash : 1);
     }
 
-    static UNumber Hash(const char *str, UNumber offset, UNumber limit) noexcept {
-        UNumber hash = 0;
-        UNumber base = 1;
+    inline static unsigned long long hashMix(unsigned long long a, unsigned long long b) noexcept {
+        Platform::Multiply(a, b);
+        return (a ^ b);
+    }
 
-        while (limit != 0) {
-            hash += (static_cast<UNumber>(str[offset++]) + base);
-            base += 256;
-            --limit;
-        }
+    inline static unsigned long long read8(const unsigned char *str) noexcept {
+        unsigned long long value;
+        Memory::Copy(&value, str, 8);
+        return value;
+    }
 
-        return hash;
+    inline static unsigned long long read4(const unsigned char *str) noexcept {
+        unsigned int value;
+        Memory::Copy(&value, str, 4);
+        return value;
     }
 
+    inline static UNumber Hash(const StringView &view) noexcept {
+        return Hash(view.Str, 0, view.Length);
+    }
+
+    inline static bool isSpace(const char c) noexcept {
+        return ((c == ' ') || (c == '\n') || (c == '\t') || (c == '\r'));
+    }
+
+    // Drops the spaces and the new lines around str[offset, offset + limit); it reads nothing outside of it, and an empty or a
+    // blank string ends up with no length. The runs are a few characters long, so it goes one at a time.
     static void SoftTrim(const char *str, UNumber &offset, UNumber &limit) noexcept {
-        UNumber end = limit + offset;
+        UNumber end = (offset + limit);
 
-        while ((str[offset] == ' ') || (str[offset] == '\n') || (str[offset] == '\t') || (str[offset] == '\r')) {
+        while ((offset < end) && isSpace(str[offset])) {
             ++offset;
         }
 
-        while ((--end > offset) && ((str[end] == ' ') || (str[end] == '\n') || (str[end] == '\t') || (str[end] == '\r'))) {
+        while ((end > offset) && isSpace(str[(end - 1)])) {
+            --end;
         }
-        ++end;
 
-        limit = end - offset;
+        limit = (end - offset);
+    }
+
+    static void SoftTrim(StringView &view) noexcept {
+        UNumber offset = 0;
+        SoftTrim(view.Str, offset, view.Length);
+        view.Str += offset;
     }
 
     static String Trim(const String &str) noexcept {
@@ -437,105 +505,91 @@ struct String {
         return String(&(str[len]), static_cast<UNumber>(num_len - len));
     }
 
-    static String FromNumber(double number, UShort min = 1, UShort r_min = 0, UShort r_max = 0) noexcept {
-        static constexpr UNumber num_len = 22;
-
-        UShort len    = num_len;
-        UShort p1_len = 0;
-
-        char str[num_len];
+    // At least min digits before the point and r_min after it, padded with zeros; r_max: rounds to that many digits after the
+    // point, half up, and 0 writes the shortest digits that read back as the same number. There is no exponent: it writes every
+    // zero of a big or a tiny number. NaN and the infinities come out as JavaScript writes them.
+    static String FromNumber(double number, const UShort min = 1, const UShort r_min = 0, const UShort r_max = 0) noexcept {
+        if (number != number) {
+            return String("NaN");
+        }
 
         const bool negative = (number < 0.0);
 
         if (negative) {
-            number *= -1;
+            number = -number;
         }
 
-        if (number != 0) {
-            unsigned long left = static_cast<unsigned long>(number);
-            number -= static_cast<double>(left);
-
-            if (number != 0) {
-                number *= 1e15;
-                unsigned long right = static_cast<unsigned long>(number);
-
-                if (right != 0) {
-                    UShort presision = 15;
-                    while (((right % 10) == 0) && (presision != 0)) {
-                        --presision;
-                        right /= 10;
-                    }
-
-                    if ((r_max != 0) && (r_max < presision)) {
-                        ++r_max;
-
-                        while (r_max < presision) {
-                            --presision;
-                            right /= 10;
-                        }
-
-                        if ((right % 10) >= 5) {
-                            right /= 10;
-                            ++right;
-                        } else {
-                            right /= 10;
-                        }
-
-                        --presision;
-
-                        while (((right % 10) == 0) && (presision != 0)) {
-                            --presision;
-                            right /= 10;
-                        }
-
-                        if ((right == 1) && (presision == 0)) {
-                            ++left;
-                        }
-                    }
-
-                    while (r_min > presision) {
-                        str[--len] = '0';
-                        --r_min;
-                    }
-                    r_min = 0;
-
-                    while (presision != 0) {
-                        str[--len] = char((right % 10) + 48);
-                        right /= 10;
-                        --presision;
-                    }
-
-                    if (len != num_len) {
-                        str[--len] = '.';
-                    }
-                }
-            }
+        if ((number - number) != 0.0) {
+            return String(negative ? "-Infinity" : "Infinity");
+        }
 
-            while (left != 0) {
-                str[--len] = char((left % 10) + 48);
-                left /= 10;
-                ++p1_len;
+        char digits[20];
+        int  length = 0;
+        int  point  = 0; // How many of the digits go before the point; it can be less than none, or more than there are.
+
+        if (number != 0.0) {
+            int exponent;
+            length = Digit::Shortest(number, digits, exponent);
+            point  = (length + exponent);
+
+            if (r_max != 0) {
+                length = Digit::Round(digits, length, point, r_max);
             }
         }
 
-        if (r_min != 0) {
-            do {
-                str[--len] = '0';
-            } while (--r_min != 0);
+        if (length == 0) {
+            point = 0;
+        }
+
+        const int     int_len    = ((point > 0) ? point : 0);
+        const int     frac_len   = ((length > point) ? (length - point) : 0);
+        const int     int_width  = ((int_len > min) ? int_len : min);
+        const int     frac_width = ((frac_len > r_min) ? frac_len : r_min);
+        const bool    sign       = (negative && (length != 0));
+        const UNumber total      = static_cast<UNumber>(static_cast<int>(sign) + int_width + ((frac_width != 0) ? (frac_width + 1) : 0));
+
+        String ns(total);
+        char * str = ns.Str;
 
-            str[--len] = '.';
+        if (sign) {
+            *(str++) = '-';
         }
 
-        while (p1_len < min) {
-            str[--len] = '0';
-            ++p1_len;
+        for (int i = int_len; i < int_width; i++) {
+            *(str++) = '0';
         }
 
-        if (negative) {
-            str[--len] = '-';
+        if (int_len != 0) {
+            const int count = ((int_len < length) ? int_len : length);
+            Memory::Copy(str, digits, static_cast<UNumber>(count));
+            str += count;
+
+            for (int i = count; i < int_len; i++) {
+                *(str++) = '0';
+            }
         }
 
-        return String(&(str[len]), (num_len - len));
+        if (frac_width != 0) {
+            *(str++) = '.';
+
+            for (int i = point; i < 0; i++) {
+                *(str++) = '0';
+            }
+
+            if (length > int_len) {
+                Memory::Copy(str, (digits + int_len), static_cast<UNumber>(length - int_len));
+                str += (length - int_len);
+            }
+
+            for (int i = frac_len; i < frac_width; i++) {
+                *(str++) = '0';
+            }
+        }
+
+        ns.Length     = total;
+        ns.Str[total] = '\0';
+
+        return ns;
     }
 
     inline static String FromNumber(UShort number, const UShort min = 1) noexcept {
@@ -554,105 +608,22 @@ struct String {
         return FromNumber(static_cast<double>(number), min, 0, 0);
     }
 
-    static bool ToNumber(UNumber &number, const char *str, const UNumber offset, UNumber limit) noexcept {
-        limit += offset;
-        number = 0;
-
-        UNumber exp     = 0;
-        UNumber postion = 1;
-        char    c;
-
-        while (limit != offset) {
-            c = str[--limit];
-
-            if ((c <= 47) || (c >= 58)) {
-                switch (c) {
-                    case 'e':
-                    case 'E': {
-                        exp     = number;
-                        number  = 0;
-                        postion = 1;
-                        break;
-                    }
-                    case '+':
-                        break;
-                    default:
-                        number = 0.0;
-                        return false;
-                }
-            } else {
-                number += ((static_cast<UNumber>(c) - 48) * postion);
-                postion *= 10;
-            }
-        }
-
-        while (exp != 0) {
-            number *= 10;
-            --exp;
-        }
+    // Digit::ToUNumber(): digits, and an exponent or not.
+    inline static bool ToNumber(UNumber &number, const char *str, const UNumber offset, const UNumber limit) noexcept {
+        return Digit::ToUNumber(number, (str + offset), limit);
+    }
 
-        return (postion > 1);
-    }
-
-    static bool ToNumber(double &number, const char *str, const UNumber offset, UNumber limit) noexcept {
-        number = 0.0;
-        limit += offset;
-
-        bool    negative_exp = false;
-        UNumber exp          = 0;
-        double  postion      = 1.0;
-        char    c;
-
-        while (limit != offset) {
-            c = str[--limit];
-
-            if ((c <= 47) || (c >= 58)) {
-                switch (c) {
-                    case '.': {
-                        number /= postion;
-                        postion = 1.0;
-                        break;
-                    }
-                    case 'e':
-                    case 'E': {
-                        exp     = static_cast<UNumber>(number);
-                        number  = 0.0;
-                        postion = 1.0;
-                        break;
-                    }
-                    case '+':
-                        break;
-                    case '-': {
-                        if (limit != offset) {
-                            negative_exp = true;
-                        } else {
-                            number *= -1.0;
-                        }
-                        break;
-                    }
-                    default:
-                        number = 0.0;
-                        return false;
-                }
-            } else {
-                number += ((static_cast<double>(c) - 48) * postion);
-                postion *= 10;
-            }
-        }
+    // Digit::ToDouble(): the nearest double to the number.
+    inline static bool ToNumber(double &number, const char *str, const UNumber offset, const UNumber limit) noexcept {
+        return Digit::ToDouble(number, (str + offset), limit);
+    }
 
-        if (negative_exp) {
-            while (exp != 0) {
-                number /= 10;
-                --exp;
-            }
-        } else {
-            while (exp != 0) {
-                number *= 10;
-                --exp;
-            }
-        }
+    inline static bool ToNumber(UNumber &number, const StringView &view) noexcept {
+        return ToNumber(number, view.Str, 0, view.Length);
+    }
 
-        return (postion > 1.0);
+    inline static bool ToNumber(double &number, const StringView &view) noexcept {
+        return ToNumber(number, view.Str, 0, view.Length);
     }
 };
 
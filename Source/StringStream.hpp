@@ -9,8 +9,14 @@
  */
 
 #include "Array.hpp"
+#include "Platform.hpp"
 #include "String.hpp"
 
+#if defined(QENTEM_POSIX)
+#include <cerrno>
+#include <sys/uio.h>
+#endif
+
 #ifndef QENTEM_STRINGSTREAM_H
 #define QENTEM_STRINGSTREAM_H
 
@@ -23,9 +29,17 @@ struct StringStream {
         char *      Collect;
     };
 
+    // Takes all the pieces, in order, to write them out without joining them; false: it failed.
+    using GatherCB_ = bool(const StringBit *bits, UNumber count, void *target);
+
     Array<StringBit> Bits;
     UNumber          Length{0};
 
+    StringStream() = default;
+
+    StringStream(const StringStream &src) = delete;
+    StringStream &operator=(const StringStream &src) = delete;
+
     void Add(const UNumber length, const char *str) noexcept {
         if (length != 0) {
             Length += length;
@@ -43,38 +57,119 @@ struct StringStream {
         Add(src.Length, src.Str);
     }
 
+    // The characters are not copied: they have to outlive ToString().
+    inline void operator+=(const StringView &src) noexcept {
+        Add(src.Length, src.Str);
+    }
+
     inline void operator+=(String &&src) noexcept {
         if (src.Length != 0) {
-            Length += src.Length;
-            Bits += {src.Length, src.Str, src.Str};
-            src.Str = nullptr;
+            const UNumber length = src.Length;
+            char *        str    = src.Eject(); // A short one is copied out of src.
+
+            Length += length;
+            Bits += {length, str, str};
         }
     }
 
     String ToString() noexcept {
         String tmp(Length);
-        Length = 0;
 
         StringBit *bit;
-        UNumber    j;
 
         for (UNumber i = 0; i < Bits.Size; i++) {
             bit = &(Bits[i]);
 
-            for (j = 0; j < bit->Length; j++) {
-                tmp[tmp.Length++] = bit->Str[j];
+            Memory::Copy(&(tmp.Str[tmp.Length]), bit->Str, bit->Length);
+            tmp.Length += bit->Length;
+        }
+
+        tmp[tmp.Length] = '\0';
+
+        Reset();
+
+        return tmp;
+    }
+
+    // Gives the pieces to the writer as they are, and empties the stream.
+    bool Flush(GatherCB_ *writer, void *target) noexcept {
+        const bool done = ((Bits.Size == 0) || writer(Bits.Storage, Bits.Size, target));
+
+        Reset();
+
+        return done;
+    }
+
+#if defined(QENTEM_POSIX)
+    // Writes the pieces to a file, a pipe or a socket with writev(); false: it failed, and what is left is dropped.
+    inline bool Flush(int fd) noexcept {
+        return Flush(&(writeVectors), &fd);
+    }
+
+    static bool writeVectors(const StringBit *bits, const UNumber count, void *target) noexcept {
+        static const UNumber batch = 512; // Under IOV_MAX, which is 1024 on Linux.
+
+        const int fd = *(static_cast<int *>(target));
+        iovec     vectors[batch];
+        UNumber   index = 0;
+
+        while (index < count) {
+            int left = 0;
+
+            while ((static_cast<UNumber>(left) < batch) && (index < count)) {
+                vectors[left].iov_base = const_cast<char *>(bits[index].Str);
+                vectors[left].iov_len  = bits[index].Length;
+                ++left;
+                ++index;
             }
 
-            if (bit->Collect != nullptr) {
-                Memory::Deallocate<char>(&(bit->Collect));
+            iovec *next = vectors;
+
+            while (left != 0) {
+                const ssize_t written = writev(fd, next, left);
+
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+
+                    return false;
+                }
+
+                // What a short write has left.
+                size_t done = static_cast<size_t>(written);
+
+                while ((left != 0) && (done >= next->iov_len)) {
+                    done -= next->iov_len;
+                    ++next;
+                    --left;
+                }
+
+                if (left != 0) {
+                    next->iov_base = (static_cast<char *>(next->iov_base) + done);
+                    next->iov_len -= done;
+                }
             }
         }
 
-        tmp[tmp.Length] = '\0';
+        return true;
+    }
+#endif
+
+    // Frees the collected strings, and drops every piece.
+    void Reset() noexcept {
+        for (UNumber i = 0; i < Bits.Size; i++) {
+            if (Bits[i].Collect != nullptr) {
+                Memory::Deallocate<char>(&(Bits[i].Collect));
+            }
+        }
 
         Bits.Reset();
+        Length = 0;
+    }
 
-        return tmp;
+    ~StringStream() noexcept {
+        Reset();
     }
 };
 
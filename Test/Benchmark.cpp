@@ -0,0 +1,699 @@
+/**
+ * Qentem Engine Benchmark
+ *
+ * @brief     For measuring Qentem Engine.
+ *
+ * @author    Hani Ammar <hani.code@outlook.com>
+ * @copyright 2019 Hani Ammar
+ * @license   https://opensource.org/licenses/MIT
+ */
+
+#include <Extension/Template.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+
+using Qentem::Array;
+using Qentem::Document;
+using Qentem::String;
+using Qentem::UNumber;
+using Qentem::VType;
+using Qentem::Engine::MatchBit;
+
+static String readFile(const char *path) noexcept;
+static String repeat(const String &content, UNumber size) noexcept;
+static String repeatJSON(const String &json, UNumber size) noexcept;
+static String nest(const char *head, const char *tail, UNumber depth) noexcept;
+static void   printRate(const char *name, UNumber bytes, UNumber ticks, UNumber times) noexcept;
+static bool   countKeys(Qentem::UShort event, const Qentem::StringView &value, void *other) noexcept;
+static void   benchMatch(const String &qtml, const String &json) noexcept;
+static void   benchLarge(const String &qtml, const String &json) noexcept;
+static void   benchDeep() noexcept;
+static void   benchAppend() noexcept;
+static void   benchStrings() noexcept;
+static void   benchKeys() noexcept;
+static void   benchTable() noexcept;
+static void   benchNumbers() noexcept;
+static void   benchCoordinates() noexcept;
+
+int main() {
+    String qtml = readFile("./Test/test.qtml");
+    String json = readFile("./Test/test.json");
+
+    if ((qtml.Length == 0) || (json.Length == 0)) {
+        return 1;
+    }
+
+    benchMatch(qtml, json);
+    benchLarge(qtml, json);
+    benchDeep();
+    benchAppend();
+    benchStrings();
+    benchKeys();
+    benchTable();
+    benchNumbers();
+    benchCoordinates();
+
+    return 0;
+}
+
+static void benchMatch(const String &qtml, const String &json) noexcept {
+    std::cout << "\n #Match:\n";
+
+    const String big  = repeat(qtml, (1024 * 1024));
+    Document     data = Document::FromJSON(json);
+    UNumber      ticks;
+    UNumber      times = 2000;
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Qentem::Engine::Match(Qentem::Template::getExpres(), qtml.Str, 0, qtml.Length);
+    }
+    printRate("Template Match (test.qtml)", qtml.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    times = 10;
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Qentem::Engine::Match(Qentem::Template::getExpres(), big.Str, 0, big.Length);
+    }
+    printRate("Template Match (1 MB)", big.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    times = 2000;
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Qentem::Engine::Match(Document::getJsonExpres(), json.Str, 0, json.Length);
+    }
+    printRate("JSON Match (test.json)", json.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    times = 2000;
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Qentem::Template::Render(qtml, &data);
+    }
+    printRate("Template Render (test.qtml)", qtml.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    Qentem::Memory::Arena arena;
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        {
+            const Qentem::Memory::AllocatorScope scope(&arena);
+            Qentem::Template::Render(qtml, &data);
+        }
+        arena.Reset();
+    }
+    printRate("Template Render (test.qtml, arena)", qtml.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    Qentem::Memory::Pool pool;
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        const Qentem::Memory::AllocatorScope scope(&pool);
+        Qentem::Template::Render(qtml, &data);
+    }
+    printRate("Template Render (test.qtml, pool)", qtml.Length, (static_cast<UNumber>(clock()) - ticks), times);
+}
+
+static void benchLarge(const String &qtml, const String &json) noexcept {
+    std::cout << "\n #Large inputs:\n";
+
+    const String big_qtml = repeat(qtml, (4 * 1024 * 1024));
+    const String big_json = repeatJSON(json, (8 * 1024 * 1024));
+    const String big_text = repeat("Mostly plain text, with a variable every now and then: {v:engine}.\n", (4 * 1024 * 1024));
+    const String big_if =
+        String("<if case=\"1\">") + repeat("Plain text inside a block, without anything to match. </i\n", (4 * 1024 * 1024)) + "</if>";
+    Document     data     = Document::FromJSON(json);
+    UNumber      ticks;
+    UNumber      times = 5;
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Qentem::Engine::Match(Qentem::Template::getExpres(), big_text.Str, 0, big_text.Length);
+    }
+    printRate("Template Match (4 MB, mostly text)", big_text.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Qentem::Engine::Match(Qentem::Template::getExpres(), big_if.Str, 0, big_if.Length);
+    }
+    printRate("Template Match (4 MB, one long block)", big_if.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Qentem::Template::Render(big_text, &data);
+    }
+    printRate("Template::Render (4 MB, mostly text)", big_text.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Qentem::Engine::Match(Document::getJsonExpres(), big_json.Str, 0, big_json.Length);
+    }
+    printRate("JSON Match (8 MB)", big_json.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    Qentem::Engine::CompactTree compact;
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Qentem::Engine::Match(compact, Document::getJsonExpres(), big_json.Str, 0, big_json.Length);
+    }
+    printRate("JSON Match into a CompactTree (8 MB)", big_json.Length, (static_cast<UNumber>(clock()) - ticks), times);
+    std::cout << " Bytes per match: " << sizeof(MatchBit) << ", compact: " << sizeof(Qentem::Engine::CompactBit) << '\n';
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Array<UNumber> index;
+        Qentem::JSON::Index(index, big_json.Str, 0, big_json.Length);
+    }
+    printRate("JSON::Index (8 MB)", big_json.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    UNumber keys = 0;
+    ticks        = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Qentem::JSON::Read(big_json.Str, 0, big_json.Length, &(countKeys), &keys);
+    }
+    printRate("JSON::Read, counting keys (8 MB)", big_json.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Qentem::JSON::Reader reader(&(countKeys), &keys);
+
+        for (UNumber offset = 0; offset < big_json.Length; offset += 65536) {
+            reader.Feed((big_json.Str + offset), (((big_json.Length - offset) < 65536) ? (big_json.Length - offset) : 65536));
+        }
+
+        reader.Finish();
+    }
+    printRate("JSON::Reader, in chunks of 64 KB (8 MB)", big_json.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    if (keys == 0) {
+        std::cout << '\n';
+    }
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Document::FromJSON(big_json);
+    }
+    printRate("Document::FromJSON (8 MB)", big_json.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    String engine;
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Document lazy = Document::FromJSONLazy(big_json);
+        lazy.GetString(engine, "100[engine]", 0, 11);
+    }
+    printRate("Document::FromJSONLazy, one value (8 MB)", big_json.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Qentem::Template::Render(big_qtml, &data);
+    }
+    printRate("Template::Render (4 MB)", big_qtml.Length, (static_cast<UNumber>(clock()) - ticks), times);
+}
+
+static void benchDeep() noexcept {
+    std::cout << "\n #Deep nesting:\n";
+
+    const String arrays  = nest("[", "]", 10000);
+    const String objects = nest("{\"a\":", "}", 10000);
+    UNumber      ticks;
+    UNumber      times = 100;
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Qentem::Engine::Match(Document::getJsonExpres(), arrays.Str, 0, arrays.Length);
+    }
+    printRate("JSON Match (10000 nested arrays)", arrays.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Qentem::Engine::Match(Document::getJsonExpres(), objects.Str, 0, objects.Length);
+    }
+    printRate("JSON Match (10000 nested objects)", objects.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Document::FromJSON(arrays);
+    }
+    printRate("Document::FromJSON (10000 nested arrays)", arrays.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Document::FromJSON(objects);
+    }
+    printRate("Document::FromJSON (10000 nested objects)", objects.Length, (static_cast<UNumber>(clock()) - ticks), times);
+}
+
+static void benchAppend() noexcept {
+    std::cout << "\n #Appending:\n";
+
+    const char *   fragments[4] = {"<td>", "value", "</td>", "\n"};
+    const UNumber  count        = (1024 * 1024);
+    UNumber        ticks;
+    const UNumber  times = 5;
+    UNumber        bytes = 0;
+    Qentem::String str;
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        str.Reset();
+
+        for (UNumber j = 0; j < count; j++) {
+            str += fragments[(j & 3)];
+        }
+    }
+    bytes = str.Length;
+    printRate("String += (1M fragments)", bytes, (static_cast<UNumber>(clock()) - ticks), times);
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        str.Reset();
+        str.Reserve(bytes);
+
+        for (UNumber j = 0; j < count; j++) {
+            str += fragments[(j & 3)];
+        }
+    }
+    printRate("String += (1M fragments, reserved)", bytes, (static_cast<UNumber>(clock()) - ticks), times);
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        Qentem::StringStream ss;
+
+        for (UNumber j = 0; j < count; j++) {
+            ss += fragments[(j & 3)];
+        }
+
+        str = ss.ToString();
+    }
+    printRate("StringStream (1M fragments)", bytes, (static_cast<UNumber>(clock()) - ticks), times);
+}
+
+static void benchStrings() noexcept {
+    std::cout << "\n #Strings:\n";
+
+    const char *  keys[4]    = {"id", "name", "engine", "version_number"};
+    const UNumber keys_bytes = (2 + 4 + 6 + 14);
+    const String  value      = repeat("Some value that goes on; ", 4096);
+    const String  other      = repeat("Some value that goes on; ", 4096);
+    const String  padded     = String("  \n\t") + repeat("x", 64) + "\r\n  ";
+    UNumber       ticks;
+    const UNumber times = (16 * 1024 * 1024);
+    volatile bool same  = false;
+    UNumber       found = 0;
+    UNumber       bytes = 0;
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        found += String::Count(keys[(i & 3)]);
+    }
+    printRate("Count (short keys)", (keys_bytes / 4), (static_cast<UNumber>(clock()) - ticks), times);
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        same = String::Compare(keys[(i & 3)], 0, 4, "name", 0, 4);
+    }
+    printRate("Compare (short keys)", 4, (static_cast<UNumber>(clock()) - ticks), times);
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < 16384; i++) {
+        same = (value == other);
+    }
+    printRate("== (100 KB values)", value.Length, (static_cast<UNumber>(clock()) - ticks), 16384);
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        UNumber offset = 0;
+        UNumber limit  = padded.Length;
+        String::SoftTrim(padded.Str, offset, limit);
+        bytes += limit;
+    }
+    printRate("SoftTrim (64 bytes, padded)", padded.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    if (same && ((found + bytes) == 0)) {
+        std::cout << '\n';
+    }
+}
+
+// 1M keys like the ones of a JSON API: how often their hashes meet, and how fast documents find them.
+static void benchKeys() noexcept {
+    std::cout << "\n #Keys:\n";
+
+    const char *   fields[16] = {"id",   "name",      "email",         "created_at", "updated_at", "city",     "role",     "is_active",
+                                 "age",  "last_ip",   "score",         "group_id",   "phone",      "country",  "language", "timezone"};
+    const UNumber  objects    = (64 * 1024);
+    const UNumber  count      = (objects * 16);
+    const UNumber  base       = 4194304; // The size of a table, a power of two, with four slots for every key.
+    Array<String>  keys(count);
+    Array<UNumber> hashes(count);
+    Array<bool>    slots;
+    UNumber        ticks;
+    UNumber        same_hash = 0;
+    UNumber        same_slot = 0;
+
+    for (UNumber i = 0; i < count; i++) {
+        keys += (String("user_") + String::FromNumber(i >> 4U) + "." + fields[(i & 15U)]);
+    }
+
+    slots.Expand(base);
+
+    for (UNumber i = 0; i < count; i++) {
+        const UNumber hash = String::Hash(keys[i].View());
+        hashes += hash;
+
+        if (slots[(hash & (base - 1))]) {
+            ++same_slot;
+        } else {
+            slots[(hash & (base - 1))] = true;
+        }
+    }
+
+    std::sort(hashes.Storage, (hashes.Storage + hashes.Size));
+
+    for (UNumber i = 1; i < hashes.Size; i++) {
+        if (hashes[i] == hashes[(i - 1)]) {
+            ++same_hash;
+        }
+    }
+
+    // What a random hash would give: the keys, less the slots that they fill.
+    const double load   = (static_cast<double>(count) / static_cast<double>(base));
+    const double random = (1.0 - ((1.0 - std::exp(-load)) / load));
+
+    std::cout << " Keys with the hash of another: " << same_hash << " of " << count << '\n';
+    const double taken = ((100.0 * static_cast<double>(same_slot)) / static_cast<double>(count));
+    std::cout << " Keys in a taken slot: " << String::FromNumber(taken, 1, 2, 2).Str << "% (a random hash: "
+              << String::FromNumber((100.0 * random), 1, 2, 2).Str << "%)\n";
+
+    // The same keys, as 64K objects of 16 members each.
+    String json("[");
+    json.Reserve(count * 24);
+
+    for (UNumber i = 0; i < objects; i++) {
+        json += ((i != 0) ? ",{" : "{");
+
+        for (UNumber j = 0; j < 16; j++) {
+            json += ((j != 0) ? ",\"" : "\"");
+            json += fields[j];
+            json += "\":";
+            json += String::FromNumber(j);
+        }
+
+        json += "}";
+    }
+
+    json += "]";
+
+    Document data = Document::FromJSON(json);
+    double   number;
+    UNumber  found = 0;
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < objects; i++) {
+        Document &object = data.Documents[i];
+
+        for (UNumber j = 0; j < 16; j++) {
+            if (object.GetNumber(number, fields[j], 0, String::Count(fields[j])) && (number == static_cast<double>(j))) {
+                ++found;
+            }
+        }
+    }
+    ticks = (static_cast<UNumber>(clock()) - ticks);
+
+    if (ticks == 0) {
+        ticks = 1;
+    }
+
+    const double seconds = (static_cast<double>(ticks) / CLOCKS_PER_SEC);
+    std::cout << " Document::GetNumber (1M keys): " << String::FromNumber(seconds, 1, 3, 3).Str << "s, "
+              << String::FromNumber(((static_cast<double>(count) / seconds) / 1000000.0), 1, 1, 1).Str << " M lookups/s\n";
+
+    if (found != count) {
+        std::cout << " Lost keys: " << (count - found) << '\n';
+    }
+}
+
+// Inserting keys into one object, and finding every one of them, from 10 keys to 1M; about 1M of each for every size.
+static void benchTable() noexcept {
+    std::cout << "\n #Object sizes:\n";
+
+    const UNumber count = (1024 * 1024);
+    Array<String> keys(count);
+    double        number = 1;
+    UNumber       ticks;
+
+    for (UNumber i = 0; i < count; i++) {
+        keys += (String("key_") + String::FromNumber(i));
+    }
+
+    for (UNumber size = 10; size <= count; size *= 10) {
+        const UNumber times = (count / size);
+        UNumber       found = 0;
+
+        ticks = static_cast<UNumber>(clock());
+        for (UNumber t = 0; t < times; t++) {
+            Document object;
+
+            for (UNumber i = 0; i < size; i++) {
+                object.Insert(keys[i].Str, 0, keys[i].Length, VType::NumberT, &number, false);
+            }
+        }
+        const UNumber insert_ticks = (static_cast<UNumber>(clock()) - ticks);
+
+        Document object;
+        for (UNumber i = 0; i < size; i++) {
+            object.Insert(keys[i].Str, 0, keys[i].Length, VType::NumberT, &number, false);
+        }
+
+        ticks = static_cast<UNumber>(clock());
+        for (UNumber t = 0; t < times; t++) {
+            for (UNumber i = 0; i < size; i++) {
+                if (object.GetNumber(number, keys[i].Str, 0, keys[i].Length)) {
+                    ++found;
+                }
+            }
+        }
+        const UNumber find_ticks = (static_cast<UNumber>(clock()) - ticks);
+
+        const double ops     = ((static_cast<double>(times * size) / 1000000.0) * CLOCKS_PER_SEC);
+        const double inserts = (ops / static_cast<double>(insert_ticks + 1));
+        const double finds   = (ops / static_cast<double>(find_ticks + 1));
+
+        std::cout << ' ' << size << " keys: " << String::FromNumber(inserts, 1, 1, 1).Str << " M inserts/s, "
+                  << String::FromNumber(finds, 1, 1, 1).Str << " M lookups/s\n";
+
+        if (found != (times * size)) {
+            std::cout << " Lost keys: " << ((times * size) - found) << '\n';
+        }
+    }
+}
+
+// 10M doubles to text: readings with all their digits, prices with two, and whole numbers.
+static void benchNumbers() noexcept {
+    std::cout << "\n #Numbers:\n";
+
+    const UNumber      times = (10 * 1000 * 1000);
+    double             numbers[4096];
+    unsigned long long seed = 88172645463325252ULL;
+    UNumber            ticks;
+    UNumber            bytes = 0;
+
+    for (UNumber i = 0; i < 4096; i++) {
+        seed ^= (seed << 13U);
+        seed ^= (seed >> 7U);
+        seed ^= (seed << 17U);
+
+        const double random = (static_cast<double>(seed >> 11U) / 9007199254740992.0); // [0, 1)
+
+        switch (i % 3) {
+            case 0: {
+                numbers[i] = ((random - 0.5) * 1e6);
+                break;
+            }
+            case 1: {
+                numbers[i] = (static_cast<double>(static_cast<UNumber>(random * 1e6)) / 100.0);
+                break;
+            }
+            default:
+                numbers[i] = static_cast<double>(static_cast<UNumber>(random * 1e9));
+        }
+    }
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        bytes += String::FromNumber(numbers[(i & 4095)]).Length;
+    }
+    printRate("FromNumber (shortest)", (bytes / times), (static_cast<UNumber>(clock()) - ticks), times);
+
+    bytes = 0;
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        bytes += String::FromNumber(numbers[(i & 4095)], 1, 0, 3).Length;
+    }
+    printRate("FromNumber (3 digits)", (bytes / times), (static_cast<UNumber>(clock()) - ticks), times);
+
+    // For reference: it always writes 17 digits.
+    char buffer[32];
+    bytes = 0;
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber i = 0; i < times; i++) {
+        bytes += static_cast<UNumber>(std::snprintf(buffer, sizeof(buffer), "%.17g", numbers[(i & 4095)]));
+    }
+    printRate("snprintf %.17g", (bytes / times), (static_cast<UNumber>(clock()) - ticks), times);
+}
+
+// A polygon like the one of canada.json: 111K points, with numbers of 15 to 17 digits.
+static void benchCoordinates() noexcept {
+    std::cout << "\n #Coordinates:\n";
+
+    const UNumber      points = (111 * 1024);
+    String             json("{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\",\"properties\":{\"name\":\"Canada\"},"
+                "\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[[");
+    Array<UNumber>     offsets((points * 2));
+    Array<UNumber>     lengths((points * 2));
+    unsigned long long seed = 88172645463325252ULL;
+    UNumber            ticks;
+    UNumber            times = 10;
+    double             sum   = 0;
+
+    json.Reserve(points * 42);
+
+    for (UNumber i = 0; i < points; i++) {
+        seed ^= (seed << 13U);
+        seed ^= (seed >> 7U);
+        seed ^= (seed << 17U);
+
+        const double longitude = (-141.0 + ((static_cast<double>(seed >> 11U) / 9007199254740992.0) * 89.0));
+        const double latitude  = (41.0 + ((static_cast<double>(seed & 0xFFFFFFFFFFFFFULL) / 4503599627370496.0) * 42.0));
+        const String lon_text  = String::FromNumber(longitude);
+        const String lat_text  = String::FromNumber(latitude);
+
+        json += ((i != 0) ? ",[" : "[");
+        offsets += json.Length;
+        lengths += lon_text.Length;
+        json += lon_text;
+        json += ",";
+        offsets += json.Length;
+        lengths += lat_text.Length;
+        json += lat_text;
+        json += "]";
+    }
+
+    json += "]]}}]}";
+
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber t = 0; t < times; t++) {
+        for (UNumber i = 0; i < offsets.Size; i++) {
+            double number;
+            String::ToNumber(number, json.Str, offsets[i], lengths[i]);
+            sum += number;
+        }
+    }
+    printRate("ToNumber (222K numbers)", json.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    times = 5;
+    ticks = static_cast<UNumber>(clock());
+    for (UNumber t = 0; t < times; t++) {
+        Document data = Document::FromJSON(json);
+    }
+    printRate("Document::FromJSON (canada-like)", json.Length, (static_cast<UNumber>(clock()) - ticks), times);
+
+    if (sum == 0) {
+        std::cout << '\n';
+    }
+}
+
+static bool countKeys(const Qentem::UShort event, const Qentem::StringView &value, void *other) noexcept {
+    if (event == Qentem::JSON::Events::KEY) {
+        ++(*(static_cast<UNumber *>(other)));
+    }
+
+    return true;
+}
+
+static void printRate(const char *name, const UNumber bytes, UNumber ticks, const UNumber times) noexcept {
+    if (ticks == 0) {
+        ticks = 1;
+    }
+
+    const double seconds = (static_cast<double>(ticks) / CLOCKS_PER_SEC);
+    const double rate    = ((static_cast<double>(bytes) * static_cast<double>(times)) / (1024.0 * 1024.0)) / seconds;
+
+    std::cout << ' ' << name << ": " << String::FromNumber(seconds, 1, 3, 3).Str << "s, " << String::FromNumber(rate, 1, 1, 1).Str
+              << " MB/s\n";
+}
+
+static String repeat(const String &content, const UNumber size) noexcept {
+    String  big(size + content.Length);
+    UNumber i;
+
+    while (big.Length < size) {
+        for (i = 0; i < content.Length; i++) {
+            big[big.Length++] = content[i];
+        }
+    }
+
+    big[big.Length] = '\0';
+
+    return big;
+}
+
+// An array of copies of the given JSON document.
+static String repeatJSON(const String &json, const UNumber size) noexcept {
+    String  big(size + json.Length + 2);
+    UNumber i;
+
+    big[big.Length++] = '[';
+
+    while (big.Length < size) {
+        if (big.Length != 1) {
+            big[big.Length++] = ',';
+        }
+
+        for (i = 0; i < json.Length; i++) {
+            big[big.Length++] = json[i];
+        }
+    }
+
+    big[big.Length++] = ']';
+    big[big.Length]   = '\0';
+
+    return big;
+}
+
+// depth heads, a 1, and depth tails.
+static String nest(const char *head, const char *tail, const UNumber depth) noexcept {
+    Qentem::StringStream ss;
+
+    for (UNumber i = 0; i < depth; i++) {
+        ss += head;
+    }
+
+    ss += "1";
+
+    for (UNumber i = 0; i < depth; i++) {
+        ss += tail;
+    }
+
+    return ss.ToString();
+}
+
+static String readFile(const char *path) noexcept {
+    std::ifstream file(path, std::ios::ate | std::ios::out);
+    if (file.is_open()) {
+        std::streampos size = file.tellg();
+        file.seekg(0, std::ios::beg);
+
+        String content(static_cast<UNumber>(size));
+        content.Length = content.Capacity;
+
+        file.read(content.Str, size);
+        file.close();
+
+        content[content.Length] = '\0';
+        return content;
+    }
+
+    std::cout << "Unable to load: " << path << '\n';
+
+    return "";
+}
@@ -10,17 +10,29 @@
 
 #include "Test.hpp"
 #include <Extension/XML.hpp>
+#include <cstdlib>
 #include <ctime>
 #include <fstream>
 #include <iostream>
 
+#if defined(QENTEM_POSIX)
+#include <unistd.h>
+#endif
+
 using Qentem::Array;
 using Qentem::Document;
+using Qentem::Sink;
 using Qentem::String;
 using Qentem::StringStream;
+using Qentem::StringView;
 using Qentem::UNumber;
 using Qentem::UShort;
+using Qentem::VType;
+using Qentem::Engine::CompactBit;
+using Qentem::Engine::CompactTree;
 using Qentem::Engine::MatchBit;
+using Qentem::Engine::MatchStream;
+using Qentem::Engine::MatchTree;
 using Qentem::Test::TestBit;
 using Qentem::XMLParser::XTag;
 
@@ -37,8 +49,27 @@ static bool     runTest(const char *name, const Array<TestBit> &bits, bool break
                         ParseType parse_type = ParseType::Engine) noexcept;
 static bool     NumbersConvTest() noexcept;
 static bool     XMLTest() noexcept;
+static bool     StreamTest() noexcept;
+static bool     DepthTest() noexcept;
+static bool     VisitTest() noexcept;
+static void     visitToArray(const char *content, const MatchBit &item, UShort event, void *other) noexcept;
+static void     treeToArray(Array<MatchBit> &list, const Qentem::Engine::MatchList &items) noexcept;
+static bool     CompactTest() noexcept;
+static bool     sameAsCompact(const Qentem::Engine::Expressions &expres, const char *content, CompactTree &compact) noexcept;
+static void     compactToArray(Array<MatchBit> &list, const CompactTree &tree, const CompactBit *items, UNumber count) noexcept;
+static bool     AllocatorTest() noexcept;
+static bool     ArrayTest() noexcept;
+static bool     StringTest() noexcept;
+static String   nest(const char *head, const char *tail, UNumber depth) noexcept;
+static void     writeToString(const char *str, UNumber length, void *target) noexcept;
+static bool     gatherToString(const StringStream::StringBit *bits, UNumber count, void *target) noexcept;
 static bool     JSONTest() noexcept;
 static Document getDocument() noexcept;
+static bool     readToString(UShort event, const StringView &value, void *target) noexcept;
+static bool     readUntilB(UShort event, const StringView &value, void *target) noexcept;
+#if defined(QENTEM_MEMORY_STATS)
+static void addMemoryStats(StringStream &ss) noexcept;
+#endif
 
 struct NCTest {
     double      Number{0};
@@ -63,6 +94,13 @@ int main() {
     bool TestALE      = false;
     bool TestTemplate = false;
     bool TestXML      = false;
+    bool TestStream   = false;
+    bool TestDepth    = false;
+    bool TestVisit    = false;
+    bool TestCompact  = false;
+    bool TestMemory   = false;
+    bool TestArray    = false;
+    bool TestString   = false;
     bool TestJSON     = false;
 
     // This way is faster; just comment out the line instead of changing the value.
@@ -74,6 +112,13 @@ int main() {
         TestALE      = true;
         TestTemplate = true;
         TestXML      = true;
+        TestStream   = true;
+        TestDepth    = true;
+        TestVisit    = true;
+        TestCompact  = true;
+        TestMemory   = true;
+        TestArray    = true;
+        TestString   = true;
     }
 
     TestJSON = true;
@@ -133,6 +178,69 @@ int main() {
             std::cout << "\n///////////////////////////////////////////////\n";
         }
 
+        if (TestStream) {
+            // Chunked matching Test
+            Pass = StreamTest();
+            if (!Pass) {
+                break;
+            }
+            std::cout << "\n///////////////////////////////////////////////\n";
+        }
+
+        if (TestDepth) {
+            // Deep nesting Test
+            Pass = DepthTest();
+            if (!Pass) {
+                break;
+            }
+            std::cout << "\n///////////////////////////////////////////////\n";
+        }
+
+        if (TestVisit) {
+            // Visiting Test
+            Pass = VisitTest();
+            if (!Pass) {
+                break;
+            }
+            std::cout << "\n///////////////////////////////////////////////\n";
+        }
+
+        if (TestCompact) {
+            // Compact tree Test
+            Pass = CompactTest();
+            if (!Pass) {
+                break;
+            }
+            std::cout << "\n///////////////////////////////////////////////\n";
+        }
+
+        if (TestMemory) {
+            // Allocators Test
+            Pass = AllocatorTest();
+            if (!Pass) {
+                break;
+            }
+            std::cout << "\n///////////////////////////////////////////////\n";
+        }
+
+        if (TestArray) {
+            // Array Test
+            Pass = ArrayTest();
+            if (!Pass) {
+                break;
+            }
+            std::cout << "\n///////////////////////////////////////////////\n";
+        }
+
+        if (TestString) {
+            // String Test
+            Pass = StringTest();
+            if (!Pass) {
+                break;
+            }
+            std::cout << "\n///////////////////////////////////////////////\n";
+        }
+
         if (TestJSON) {
             // JSON Test
             Pass = JSONTest();
@@ -173,8 +281,12 @@ static bool runTest(const char *name, const Array<TestBit> &bits, bool break_on_
     UNumber       length       = 0;
     bool          Pass         = false;
 
-    StringStream    ss;
-    Array<MatchBit> matches;
+#if defined(QENTEM_MEMORY_STATS)
+    Qentem::Memory::ResetStats();
+#endif
+
+    StringStream ss;
+    MatchTree    matches;
 
     ss += "\n #";
     ss += name;
@@ -316,11 +428,45 @@ static bool runTest(const char *name, const Array<TestBit> &bits, bool break_on_
     ss += "s Total Parse: ";
     ss += String::FromNumber((static_cast<double>(total_parse) / CLOCKS_PER_SEC), 2, 3, 3) + "s\n";
 
+#if defined(QENTEM_MEMORY_STATS)
+    addMemoryStats(ss);
+#endif
+
     std::cout << ss.ToString().Str;
 
     return (fail == 0);
 }
 
+#if defined(QENTEM_MEMORY_STATS)
+// What the test has allocated and freed, and the most that it has held at once.
+static void addMemoryStats(StringStream &ss) noexcept {
+    static const char *kinds[] = {"String", "Array", "Document", "Match"};
+
+    const Qentem::Memory::Stats &stats = Qentem::Memory::GetStats();
+
+    ss += " Allocations: ";
+    ss += String::FromNumber(stats.Total.Allocations);
+    ss += " Frees: ";
+    ss += String::FromNumber(stats.Total.Frees);
+    ss += " Peak: ";
+    ss += String::FromNumber((static_cast<double>(stats.Total.PeakBytes) / 1024), 1, 0, 1) + "KB (";
+
+    for (UShort i = 0; i < Qentem::Memory::Stats::Kinds; i++) {
+        if (i != 0) {
+            ss += ", ";
+        }
+
+        ss += kinds[i];
+        ss += ": ";
+        ss += String::FromNumber(stats.ByKind[i].Allocations);
+        ss += "/";
+        ss += String::FromNumber((static_cast<double>(stats.ByKind[i].PeakBytes) / 1024), 1, 0, 1) + "KB";
+    }
+
+    ss += ")\n";
+}
+#endif
+
 static bool NumbersConvTest() noexcept {
     Array<NCTest> test;
     const UNumber times       = StreasTest ? 100000 : 1;
@@ -357,6 +503,11 @@ static bool NumbersConvTest() noexcept {
     test.Add({55.0055, "55.0055", 14}).Add({55.0000055, "55.0000055"});
 
     test.Add({0.00056599999999999999, "0.001", 3});
+
+    // The shortest digits that read back, and rounding that carries.
+    test.Add({(0.1 + 0.2), "0.30000000000000004"}).Add({(1.0 / 3.0), "0.3333333333333333"}).Add({1e21, "1000000000000000000000"});
+    test.Add({-123456.78901234567, "-123456.78901234567"}).Add({9007199254740993.0, "9007199254740992"});
+    test.Add({-1.996, "-2", 2}).Add({9.9999, "10", 2}).Add({-0.0001, "0", 2});
     ////////////////////////////////
 
     std::cout << "\n #Number Conversion Test:\n";
@@ -491,6 +642,676 @@ static bool XMLTest() noexcept {
     return Pass;
 }
 
+static bool StreamTest() noexcept {
+    const UNumber sizes[] = {1, 2, 3, 7, 64, 4096};
+    bool          Pass    = true;
+    std::cout << "\n #Stream Test:\n";
+
+    String qtml = readFile("./Test/test.qtml");
+    String json = readFile("./Test/test.json");
+    if (qtml.Length == 0) {
+        qtml = readFile("./test.qtml");
+        json = readFile("./test.json");
+    }
+
+    Document     data     = Document::FromJSON(json);
+    const String expected = Qentem::Template::Render(qtml, &data);
+
+    for (UNumber s = 0; s < 6; s++) {
+        MatchStream  stream(Qentem::Template::getExpres());
+        StringStream rendered;
+        UNumber      length;
+
+        for (UNumber offset = 0; offset < qtml.Length; offset += sizes[s]) {
+            length = ((qtml.Length - offset) < sizes[s]) ? (qtml.Length - offset) : sizes[s];
+
+            const MatchTree &matches = stream.Feed(&(qtml.Str[offset]), length);
+            if (stream.Done != 0) {
+                rendered += Qentem::Engine::Parse(matches, stream.Content.Str, 0, stream.Done, &data);
+            }
+        }
+
+        const MatchTree &matches = stream.Finish();
+        rendered += Qentem::Engine::Parse(matches, stream.Content.Str, 0, stream.Done, &data);
+
+        if ((rendered.ToString() == expected) && ((stream.Base + stream.Content.Length) == qtml.Length)) {
+            std::cout << " Pass";
+        } else {
+            std::cout << " Fail";
+            Pass = false;
+        }
+        std::cout << " Chunks of " << String::FromNumber(sizes[s]).Str << " bytes\n";
+    }
+
+    String written;
+    {
+        Sink sink(&writeToString, &written, 100);
+        Qentem::Template::Render(sink, qtml.Str, 0, qtml.Length, &data);
+    }
+
+    if ((written == expected) && (written.Length > 100)) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Sink with a writer\n";
+
+    char buffer[64];
+    Sink fixed(&(buffer[0]), 64);
+    Qentem::Template::Render(fixed, qtml.Str, 0, qtml.Length, &data);
+
+    if (fixed.Overflow && (fixed.Length == 63) && (String::Part(expected.Str, 0, 63) == &(buffer[0]))) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Sink with a fixed buffer\n";
+
+    buffer[0] = 'x';
+    Sink none(&(buffer[0]), 0);
+    Qentem::Template::Render(none, qtml.Str, 0, qtml.Length, &data);
+
+    if (none.Overflow && (none.Length == 0) && (buffer[0] == 'x') && (none.ToString().Length == 0)) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Sink with a buffer of no size\n";
+
+    if (Pass) {
+        std::cout << "\n Stream looks good!\n";
+    } else {
+        std::cout << "\n Stream test failed!\n\n";
+    }
+
+    return Pass;
+}
+
+static bool DepthTest() noexcept {
+    bool Pass = true;
+    std::cout << "\n #Depth Test:\n";
+
+    const String arrays  = nest("[", "]", 10000);
+    const String objects = nest("{\"a\":", "}", 10000);
+
+    MatchTree matches = Qentem::Engine::Match(Document::getJsonExpres(), arrays.Str, 0, arrays.Length);
+    bool      whole   = ((matches.Size == 1) && !matches.TooDeep && (matches[0].Length == arrays.Length));
+
+    matches = Qentem::Engine::Match(Document::getJsonExpres(), objects.Str, 0, objects.Length);
+    if (whole && (matches.Size == 1) && !matches.TooDeep && (matches[0].Length == objects.Length)) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Matching 10000 nested arrays and objects\n";
+
+    // Document itself recurses for every level.
+    const String documents = nest("[{\"a\":", "}]", 500);
+    if (Document::FromJSON(documents).ToJSON() == documents) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Importing and exporting 1000 nested arrays and objects\n";
+
+    MatchTree limited;
+    limited.MaxDepth = 100;
+
+    String content = nest("[", "]", 100);
+    Qentem::Engine::Match(limited, Document::getJsonExpres(), content.Str, 0, content.Length);
+    bool fits = ((limited.Size == 1) && !limited.TooDeep);
+
+    content = nest("[", "]", 101);
+    Qentem::Engine::Match(limited, Document::getJsonExpres(), content.Str, 0, content.Length);
+
+    if (fits && (limited.Size == 0) && limited.TooDeep) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Stopping at MaxDepth\n";
+
+    if (Pass) {
+        std::cout << "\n Depth looks good!\n";
+    } else {
+        std::cout << "\n Depth test failed!\n\n";
+    }
+
+    return Pass;
+}
+
+static bool VisitTest() noexcept {
+    bool Pass = true;
+    std::cout << "\n #Visit Test:\n";
+
+    String json = readFile("./Test/test.json");
+    if (json.Length == 0) {
+        json = readFile("./test.json");
+    }
+
+    const char *contents[] = {json.Str, "{\"a\":[1,2,{\"b\":\"}\"}]}", "[1,\"]\"]]", "{\"a}\"", "[[[", "[1,[2,\"3]"};
+
+    for (UNumber i = 0; i < 6; i++) {
+        const UNumber   length = String::Count(contents[i]);
+        const MatchTree tree   = Qentem::Engine::Match(Document::getJsonExpres(), contents[i], 0, length);
+        Array<MatchBit> matched;
+        Array<MatchBit> visited;
+        bool            same;
+
+        treeToArray(matched, tree);
+        Qentem::Engine::Visit(Document::getJsonExpres(), contents[i], 0, length, &(visitToArray), &visited);
+
+        same = (matched.Size == visited.Size);
+        for (UNumber j = 0; same && (j < matched.Size); j++) {
+            same = ((matched[j].Offset == visited[j].Offset) && (matched[j].Length == visited[j].Length) &&
+                    (matched[j].Expr == visited[j].Expr));
+        }
+
+        if (same) {
+            std::cout << " Pass";
+        } else {
+            std::cout << " Fail";
+            Pass = false;
+        }
+        std::cout << " Visiting what Match() finds (" << String::FromNumber(i).Str << ")\n";
+    }
+
+    const Document data = Document::FromJSON("/* A comment */ {\"a\": 1, // Another one\n \"b\": [2] /**/}", true);
+
+    if (data.ToJSON() == "{\"a\":1,\"b\":[2]}") {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Dropping comments while visiting\n";
+
+    if (Pass) {
+        std::cout << "\n Visit looks good!\n";
+    } else {
+        std::cout << "\n Visit test failed!\n\n";
+    }
+
+    return Pass;
+}
+
+// Every match that has a length, in the order that Visit() gives them: sub matches before the match that holds them.
+static void visitToArray(const char *content, const MatchBit &item, const UShort event, void *other) noexcept {
+    if ((event != Qentem::Engine::Events::ENTER) && (item.Length != 0)) {
+        *(static_cast<Array<MatchBit> *>(other)) += item;
+    }
+}
+
+static void treeToArray(Array<MatchBit> &list, const Qentem::Engine::MatchList &items) noexcept {
+    for (UNumber i = 0; i < items.Size; i++) {
+        treeToArray(list, items[i].NestMatch);
+        list += items[i];
+    }
+}
+
+static bool CompactTest() noexcept {
+    bool Pass = true;
+    std::cout << "\n #Compact Test:\n";
+
+    Array<TestBit> bits = Qentem::Test::GetEngineBits();
+    CompactTree    compact;
+    bool           same = true;
+
+    for (UNumber i = 0; i < bits.Size; i++) {
+        for (UNumber t = 0; t < bits[i].Content.Size; t++) {
+            if (!sameAsCompact(bits[i].Expres, bits[i].Content[t], compact)) {
+                std::cout << " Line " << String::FromNumber(bits[i].Line).Str << ':';
+                same = false;
+            }
+        }
+    }
+
+    Qentem::Test::CleanBits(bits);
+
+    if (same) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Matching the engine tests into a CompactTree\n";
+
+    String json = readFile("./Test/test.json");
+    if (json.Length == 0) {
+        json = readFile("./test.json");
+    }
+
+    if (sameAsCompact(Document::getJsonExpres(), json.Str, compact) &&
+        sameAsCompact(Qentem::XMLParser::getPropertiesExpres(), "a=\"1\"   b=2 c   =  \"3 4\"", compact)) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Matching JSON and XML properties into a CompactTree\n";
+
+    CompactTree limited;
+    limited.MaxDepth     = 10;
+    const String content = nest("[", "]", 11);
+    Qentem::Engine::Match(limited, Document::getJsonExpres(), content.Str, 0, content.Length);
+
+    CompactTree moved(static_cast<CompactTree &&>(limited));
+    CompactTree assigned;
+    const bool  deep = (moved.TooDeep && (moved.MaxDepth == 10));
+    assigned         = static_cast<CompactTree &&>(moved);
+
+    if (deep && assigned.TooDeep && (assigned.MaxDepth == 10) && (assigned.Stack.Size == 0)) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Moving a CompactTree that stopped at MaxDepth\n";
+
+    if (Pass) {
+        std::cout << "\n Compact looks good!\n";
+    } else {
+        std::cout << "\n Compact test failed!\n\n";
+    }
+
+    return Pass;
+}
+
+// Matches content into a MatchTree and into the CompactTree, and compares the two.
+static bool sameAsCompact(const Qentem::Engine::Expressions &expres, const char *content, CompactTree &compact) noexcept {
+    const UNumber   length = String::Count(content);
+    const MatchTree tree   = Qentem::Engine::Match(expres, content, 0, length);
+    Array<MatchBit> matched;
+    Array<MatchBit> compacted;
+
+    Qentem::Engine::Match(compact, expres, content, 0, length);
+
+    treeToArray(matched, tree);
+    compactToArray(compacted, compact, compact.Stack.Storage, compact.Stack.Size);
+
+    if (matched.Size != compacted.Size) {
+        return false;
+    }
+
+    for (UNumber i = 0; i < matched.Size; i++) {
+        if ((matched[i].Offset != compacted[i].Offset) || (matched[i].Length != compacted[i].Length) ||
+            (matched[i].Expr != compacted[i].Expr)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void compactToArray(Array<MatchBit> &list, const CompactTree &tree, const CompactBit *items, const UNumber count) noexcept {
+    MatchBit item;
+
+    for (UNumber i = 0; i < count; i++) {
+        compactToArray(list, tree, tree.SubMatches(items[i]), items[i].Count);
+
+        item.Offset = items[i].Offset;
+        item.Length = items[i].Length;
+        item.Expr   = tree.ExprOf(items[i]);
+        list += item;
+    }
+}
+
+static bool AllocatorTest() noexcept {
+    bool Pass = true;
+    std::cout << "\n #Allocator Test:\n";
+
+    String qtml = readFile("./Test/test.qtml");
+    String json = readFile("./Test/test.json");
+    if (qtml.Length == 0) {
+        qtml = readFile("./test.qtml");
+        json = readFile("./test.json");
+    }
+
+    Document       data     = Document::FromJSON(json);
+    const String   expected = Qentem::Template::Render(qtml, &data);
+    String         before("Made before the scope");
+    bool           same;
+
+    Qentem::Memory::Arena arena(1024);
+    {
+        const Qentem::Memory::AllocatorScope scope(&arena);
+
+        same   = ((Qentem::Template::Render(qtml, &data) == expected) && (Document::FromJSON(json).ToJSON() == data.ToJSON()));
+        before.Reset(); // The buffer goes back to delete.
+    }
+    arena.Reset();
+
+    if (same && (arena.Chunks != nullptr) && (arena.Chunks->Next == nullptr) && (before.Str == nullptr)) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Rendering and parsing in an arena\n";
+
+    Qentem::Memory::Pool pool;
+    {
+        const Qentem::Memory::AllocatorScope scope(&pool);
+
+        same = (Qentem::Template::Render(qtml, &data) == expected);
+
+        // The second time takes what the first one has freed.
+        const Qentem::Memory::Chunk *chunks = pool.Blocks.Chunks;
+        same = (same && (Qentem::Template::Render(qtml, &data) == expected) && (pool.Blocks.Chunks == chunks));
+    }
+
+    if (same && (Qentem::Memory::Current() == nullptr)) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Rendering with a pool\n";
+
+#if defined(QENTEM_MEMORY_STATS)
+    const Qentem::Memory::Counts &strings = Qentem::Memory::GetStats().ByKind[Qentem::Memory::StringK];
+    Qentem::Memory::ResetStats();
+    {
+        const UNumber bytes = strings.Bytes;
+        String        str("A string that is too long to be kept inside the object");
+        same = ((strings.Allocations == 1) && (strings.Bytes > bytes) && (strings.PeakBytes == strings.Bytes));
+        str.Reset();
+        same = (same && (strings.Frees == 1) && (strings.Bytes == bytes) && (strings.PeakBytes > bytes));
+    }
+
+    if (same) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Counting allocations\n";
+#endif
+
+    if (Pass) {
+        std::cout << "\n Allocators look good!\n";
+    } else {
+        std::cout << "\n Allocator test failed!\n\n";
+    }
+
+    return Pass;
+}
+
+static bool ArrayTest() noexcept {
+    bool Pass = true;
+    std::cout << "\n #Array Test:\n";
+
+    Array<String> strings;
+    strings.Reserve(2);
+    strings.Emplace("b");
+    strings.Emplace("d");
+    strings.Insert(0, String("a"));
+    strings.Insert(2, String("c"));
+    strings += strings[0]; // Grows while it copies one of its own.
+    strings.Remove(4);
+
+    if ((strings.Size == 4) && (strings[0] == "a") && (strings[1] == "b") && (strings[2] == "c") && (strings[3] == "d")) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Emplace, Insert and Remove\n";
+
+    Array<Array<String>> lists;
+    lists.Expand(3);
+    lists[2] += strings;
+    lists.Remove(0);
+    lists.Resize(1);
+
+    if ((lists.Size == 1) && (lists[0].Size == 0) && (lists.Capacity == 1)) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Expand, and Resize below the size\n";
+
+    if (Pass) {
+        std::cout << "\n Array looks good!\n";
+    } else {
+        std::cout << "\n Array test failed!\n\n";
+    }
+
+    return Pass;
+}
+
+static bool StringTest() noexcept {
+    bool Pass = true;
+    std::cout << "\n #String Test:\n";
+
+    // Short strings live inside the object, until they grow.
+    Array<String> strings;
+    strings.Emplace("a");
+    strings.Emplace("b");
+
+    String short_str("0123456789abcde");
+    String moved(static_cast<String &&>(short_str));
+    strings.Insert(0, static_cast<String &&>(moved));
+    moved = strings[0];
+    moved += "f";
+    char *ejected = strings[0].Eject();
+
+    if ((short_str.Str == nullptr) && (moved == "0123456789abcdef") && (String::Count(ejected) == 15) && (strings.Size == 3) &&
+        (strings[2] == "b")) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Short strings: move, grow and Eject\n";
+
+    Qentem::Memory::Deallocate<char>(&ejected);
+
+    const char *content = "{ 12.5 }key";
+    StringView  number(content, 1, 6);
+    StringView  key(content, 8, 3);
+    double      value = 0;
+    String::SoftTrim(number);
+
+    String joined(key);
+    joined += StringView(content, 0, 1);
+
+    if ((number.Length == 4) && String::ToNumber(value, number) && (value == 12.5) && (joined == "key{") && (joined != key) &&
+        (String(key) == key) && (String::Hash(key) == String::Hash("key", 0, 3)) && String::Compare(key, StringView("key", 3))) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Views: trim, number, compare and append\n";
+
+    // "ab" and "ba" had the same hash, and the second one took the place of the first.
+    Document keys = Document::FromJSON("{\"ab\": 1, \"ba\": 2}");
+    double   ab   = 0;
+    double   ba   = 0;
+    double   ca   = 0;
+
+    bool hashed = (keys.GetNumber(ab, "ab", 0, 2) && keys.GetNumber(ba, "ba", 0, 2) && !keys.GetNumber(ca, "ca", 0, 2) && (ab == 1) &&
+                   (ba == 2) && (String::Hash("", 0, 0) != 0));
+
+    if (sizeof(UNumber) == 8) { // wyhash's test vector for an empty key, and a key of 48 bytes, that is not bulk-hashed.
+        const char *key48 = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUV";
+
+        hashed = (hashed && (String::Hash("", 0, 0) == static_cast<UNumber>(0x93228a4de0eec5a2ULL)));
+        hashed = (hashed && (String::Hash(key48, 0, 48) == static_cast<UNumber>(0xc316d6cbb1aed04aULL)));
+    }
+
+    if (hashed) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Hash, and keys with the same hash\n";
+
+    // The table doubles as the keys come, and stays at most 3/4 full.
+    Document table;
+    bool     sized = true;
+
+    for (UNumber i = 0; i < 10000; i++) {
+        const String name = (String("k") + String::FromNumber(i));
+        value             = static_cast<double>(i);
+        table.Insert(name.Str, 0, name.Length, VType::NumberT, &value, false);
+        sized = (sized && ((table.Table.Size & (table.Table.Size - 1)) == 0) && ((table.Entries.Size * 4) <= (table.Table.Size * 3)));
+    }
+
+    value = 7;
+    table.Insert("k5", 0, 2, VType::NumberT, &value, false);
+    table.Delete("k6");
+    sized = (sized && (table.Entries.Size == 10000) && table.GetNumber(value, "k5", 0, 2) && (value == 7) &&
+             !table.GetNumber(value, "k6", 0, 2) && !table.GetNumber(value, "k10000", 0, 6));
+
+    table.Rehash(0);
+
+    for (UNumber i = 0; i < 10000; i++) {
+        const String name     = (String("k") + String::FromNumber(i));
+        const double expected = static_cast<double>((i != 5) ? i : 7);
+        sized = (sized && ((i == 6) || (table.GetNumber(value, name.Str, 0, name.Length) && (value == expected))));
+    }
+
+    if (sized && (table.Table.Size == 16384)) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " A table that grows with its keys\n";
+
+    // Growing by doubling, and assigning into a bigger buffer.
+    String grown;
+    grown.Reserve(32);
+    char *reserved = grown.Str;
+
+    for (UNumber i = 0; i < 8; i++) {
+        grown += "abcd";
+    }
+
+    const bool kept = (grown.Str == reserved);
+    grown += "e";
+    grown.ShrinkToFit();
+    moved = "xyz";
+    moved = moved.Str + 1;
+
+    if (kept && (grown.Length == 33) && (grown.Capacity == 33) && (grown[32] == 'e') && (moved == "yz") && (moved.Length == 2)) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Reserve, growth, ShrinkToFit and assigning\n";
+
+    // Without joining the pieces.
+    StringStream ss;
+    String       gathered;
+    ss += "{";
+    ss += String::FromNumber(12345678901234567ul);
+    ss += String::FromNumber(7ul);
+    ss += key;
+    ss.Flush(&(gatherToString), &gathered);
+
+    bool flushed = ((gathered == "{123456789012345677key") && (ss.Length == 0) && (ss.Bits.Size == 0));
+
+#if defined(QENTEM_POSIX)
+    int ends[2];
+
+    if (pipe(ends) == 0) {
+        char out[1030];
+
+        for (UNumber i = 0; i < 1030; i++) { // More than one batch.
+            ss += ((i < 515) ? "a" : "b");
+        }
+
+        flushed = (flushed && ss.Flush(ends[1]) && (read(ends[0], out, sizeof(out)) == 1030) && (out[514] == 'a') &&
+                   (out[515] == 'b'));
+        close(ends[0]);
+        close(ends[1]);
+    }
+#endif
+
+    if (flushed) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " Stream: gather and writev\n";
+
+    // Numbers of every size, from their bits; they have to read back the same.
+    unsigned long long bits   = 88172645463325252ULL;
+    bool               reread = ((String::FromNumber(1.5, 3, 3) == "001.500") && (String::FromNumber(0.5, 0) == ".5"));
+    reread                    = (reread && (String::FromNumber(5e-324).Length == 326));
+
+    for (UNumber i = 0; i < 100000; i++) {
+        bits ^= (bits << 13U);
+        bits ^= (bits >> 7U);
+        bits ^= (bits << 17U);
+
+        double random;
+        Qentem::Memory::Copy(&random, &bits, sizeof(random));
+
+        if ((random == random) && ((random - random) == 0.0)) {
+            const String text = String::FromNumber(random);
+            double       back;
+            reread = (reread && (std::strtod(text.Str, nullptr) == random) && String::ToNumber(back, text.View()) && (back == random));
+        }
+    }
+
+    if (reread) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " FromNumber: digits that read back\n";
+
+    // The nearest double: in the middle of two, the even one; and past 19 digits.
+    const char *half  = "1.00000000000000011102230246251565404236316680908203125"; // 1 + 2^-53
+    const char *above = "1.00000000000000011102230246251565404236316680908203125000000000000000000000000001";
+    double      read  = 0;
+    UNumber     whole = 0;
+    bool        parsed =
+        (String::ToNumber(read, half, 0, String::Count(half)) && (read == 1.0) && String::ToNumber(read, above, 0, String::Count(above)) &&
+         (read == 1.0000000000000002) && String::ToNumber(read, "2.2250738585072011e-308", 0, 23) && (read == 2.2250738585072011e-308) &&
+         String::ToNumber(read, "9007199254740993", 0, 16) && (read == 9007199254740992.0) && String::ToNumber(read, "-0.5e1", 0, 6) &&
+         (read == -5.0) && String::ToNumber(read, "1e400", 0, 5) && ((read - read) != 0.0) && String::ToNumber(read, "123456789", 0, 4) &&
+         (read == 1234.0));
+
+    parsed = (parsed && !String::ToNumber(read, "", 0, 0) && !String::ToNumber(read, "-", 0, 1) && !String::ToNumber(read, "1e", 0, 2) &&
+              !String::ToNumber(read, "1.2.3", 0, 5) && !String::ToNumber(read, "--1", 0, 3) && !String::ToNumber(read, "1x", 0, 2));
+
+    parsed = (parsed && String::ToNumber(whole, "4294967295", 0, 10) && (whole == 4294967295UL) &&
+              !String::ToNumber(whole, "18446744073709551616", 0, 20) && String::ToNumber(whole, "1e3", 0, 3) && (whole == 1000) &&
+              !String::ToNumber(whole, "1.5", 0, 3) && String::ToNumber(whole, "12345678901234", 0, 9) && (whole == 123456789));
+
+    if (parsed) {
+        std::cout << " Pass";
+    } else {
+        std::cout << " Fail";
+        Pass = false;
+    }
+    std::cout << " ToNumber: the nearest double, and what is not a number\n";
+
+    if (Pass) {
+        std::cout << "\n String looks good!\n";
+    } else {
+        std::cout << "\n String test failed!\n\n";
+    }
+
+    return Pass;
+}
+
 static bool JSONTest() noexcept {
     const UNumber times = ((StreasTest && !BigJSON) ? 1000 : 1);
     UNumber       took  = 0;
@@ -516,6 +1337,105 @@ static bool JSONTest() noexcept {
         }
     }
 
+    // A string that goes past a block of 64 bytes and ends in escaped backslashes, escapes, and brackets inside strings.
+    String long_x;
+    for (UNumber i = 0; i < 70; i++) {
+        long_x += "x";
+    }
+
+    const String json   = (String(R"({"a": ")") + long_x + R"(\\\\", "b":)" + "\n\t" +
+                         R"(["x\\\"y", 1 , true,null, {"c": -2.5}], "d": "{[,:]}"})");
+    Document     parsed = Document::FromJSON(json);
+    String       text;
+    double       number = 0;
+    bool         same   = (parsed.GetString(text, "a", 0, 1) && (text == (long_x + R"(\\)")));
+
+    same = (same && parsed.GetString(text, "b[0]", 0, 4) && (text == R"(x\"y)") && (parsed.ToJSON().Length != 0));
+    same = (same && parsed.GetNumber(number, "b[4][c]", 0, 7) && (number == -2.5));
+    same = (same && parsed.GetString(text, "d", 0, 1) && (text == "{[,:]}") && (parsed["b"].Entries.Size == 5));
+    same = (same && (Document::FromJSON("[1, [2]").Entries.Size == 0) && (Document::FromJSON("x: [1, 2] y").Entries.Size == 2));
+
+    if (!same) {
+        std::cout << "\n FromJSON() might be broken: strings, escapes and brackets.\n";
+        return false;
+    }
+
+    // Numbers that JSON has no text for go out as null, and come back as null.
+    const String big = Document::FromJSON(R"([1e400, -1e400, 1e300, 5e-324, {"a": -1e400}])").ToJSON();
+
+    same = ((big.Length > 300) && (String::Part(big.Str, 0, 11) == "[null,null,") && (Document::FromJSON(big).ToJSON() == big));
+    same = (same && (String::Part(big.Str, (big.Length - 13), 13) == R"(5,{"a":null}])"));
+
+    if (!same) {
+        std::cout << "\n ToJSON() might be broken: numbers that are not finite.\n";
+        return false;
+    }
+
+    // Events, stopping early, and the same events from chunks of any size.
+    const char *small  = R"(x {"a": [1, -2.5e1 , "[", {}], "b" :true, "c": null, "d": false} y)";
+    const char *until  = "1:{;5:a;3:[;7:1;7:-2.5e1;6:[;1:{;2:};4:];5:b;";
+    const char *events = "1:{;5:a;3:[;7:1;7:-2.5e1;6:[;1:{;2:};4:];5:b;8:true;5:c;10:null;5:d;9:false;2:};";
+    String      read;
+
+    same = (Qentem::JSON::Read(small, 0, String::Count(small), &(readToString), &read) && (read == events));
+    read = "";
+    same = (same && !Qentem::JSON::Read(small, 0, String::Count(small), &(readUntilB), &read) && (read == until));
+    read = "";
+    same = (same && !Qentem::JSON::Read(json.Str, 0, (json.Length - 1), &(readToString), &read));
+    same = (same && (Document::FromJSON(R"({"a": x, 2, {"b": 1} "c": true, "d": })").ToJSON() == R"({"c":true})"));
+
+    const String *texts[] = {&json, &json_content};
+    const UNumber sizes[] = {1, 2, 3, 7, 64, 100};
+    String        whole;
+
+    for (UNumber t = 0; same && (t < 2); t++) {
+        whole = "";
+        Qentem::JSON::Read(texts[t]->Str, 0, texts[t]->Length, &(readToString), &whole);
+
+        for (UNumber s = 0; same && (s < 6); s++) {
+            Qentem::JSON::Reader reader(&(readToString), &read);
+            read = "";
+
+            for (UNumber offset = 0; offset < texts[t]->Length; offset += sizes[s]) {
+                reader.Feed(&(texts[t]->Str[offset]), (((texts[t]->Length - offset) < sizes[s]) ? (texts[t]->Length - offset) : sizes[s]));
+            }
+
+            same = (reader.Finish() && (read == whole) && (reader.Content.Length < 200));
+        }
+    }
+
+    if (!same) {
+        std::cout << "\n JSON::Read() might be broken.\n";
+        return false;
+    }
+
+    // A lazy document parses a part when something looks into it, and its text lasts as long as a part needs it.
+    Document lazy    = Document::FromJSONLazy(json_content);
+    Document copy    = Document();
+    UNumber  waiting = 0;
+
+    same = (lazy.GetString(text, "abc1[1]", 0, 7) && (text == "C") && (lazy.Documents.Size > 1));
+
+    for (UNumber i = 0; i < lazy.Documents.Size; i++) {
+        if (lazy.Documents[i].Lazy.Source != nullptr) {
+            ++waiting;
+        }
+    }
+
+    same = (same && ((waiting + 1) == lazy.Documents.Size) && (lazy.ToJSON() == Document::FromJSON(json_content).ToJSON()));
+
+    {
+        const Document part = Document::FromJSONLazy(String(small));
+        copy                = part.Documents[0];
+    }
+
+    same = (same && (copy.Lazy.Source != nullptr) && (copy.ToJSON() == R"([1,-25,"[",{}])") && (copy.Lazy.Source == nullptr));
+
+    if (!same) {
+        std::cout << "\n FromJSONLazy() might be broken.\n";
+        return false;
+    }
+
     for (UNumber i = 0; i < 10; i++) {
         std::cout << " Importing... ";
         took = static_cast<UNumber>(clock());
@@ -603,6 +1523,51 @@ static Document getDocument() noexcept {
     return data;
 }
 
+// event:value; for every event that JSON::Read() gives.
+static bool readToString(const UShort event, const StringView &value, void *target) noexcept {
+    String &des = *(static_cast<String *>(target));
+    des += String::FromNumber(event);
+    des += ":";
+    String::Appand(des, value.Str, des.Length, value.Length);
+    des += ";";
+
+    return true;
+}
+
+static bool readUntilB(const UShort event, const StringView &value, void *target) noexcept {
+    return (readToString(event, value, target) && !((event == Qentem::JSON::Events::KEY) && (String(value) == "b")));
+}
+
+static void writeToString(const char *str, const UNumber length, void *target) noexcept {
+    String &des = *(static_cast<String *>(target));
+    String::Appand(des, str, des.Length, length);
+}
+
+static bool gatherToString(const StringStream::StringBit *bits, const UNumber count, void *target) noexcept {
+    for (UNumber i = 0; i < count; i++) {
+        writeToString(bits[i].Str, bits[i].Length, target);
+    }
+
+    return true;
+}
+
+// depth heads, a 1, and depth tails.
+static String nest(const char *head, const char *tail, const UNumber depth) noexcept {
+    StringStream ss;
+
+    for (UNumber i = 0; i < depth; i++) {
+        ss += head;
+    }
+
+    ss += "1";
+
+    for (UNumber i = 0; i < depth; i++) {
+        ss += tail;
+    }
+
+    return ss.ToString();
+}
+
 static String readFile(const char *path) noexcept {
     std::ifstream file(path, std::ios::ate | std::ios::out);
     if (file.is_open()) {
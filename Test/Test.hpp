@@ -20,6 +20,7 @@ using Qentem::Engine::Expression;
 using Qentem::Engine::Expressions;
 using Qentem::Engine::Flags;
 using Qentem::Engine::MatchBit;
+using Qentem::Engine::MatchList;
 
 struct TestBit {
     UNumber             Line = 0;
@@ -73,7 +74,7 @@ static String ReplaceNewLine(const char *content, UNumber length, const char *_r
     return Engine::Parse(Engine::Match(find_keys, content, 0, length), content, 0, length);
 }
 
-static Array<String> Extract(const Array<MatchBit> &items, const char *content) noexcept {
+static Array<String> Extract(const MatchList &items, const char *content) noexcept {
     Array<String> matches(items.Size);
 
     for (UNumber i = 0; i < items.Size; i++) {
@@ -84,7 +85,7 @@ static Array<String> Extract(const Array<MatchBit> &items, const char *content)
     return matches;
 }
 
-static String DumpMatches(const Array<MatchBit> &matches, const char *content, const String &offset, UNumber index = 0) noexcept {
+static String DumpMatches(const MatchList &matches, const char *content, const String &offset, UNumber index = 0) noexcept {
     if (matches.Size == 0) {
         return offset + "No matches!\n";
     }
@@ -323,6 +324,10 @@ static Array<TestBit> GetTemplateBits(Document &data) noexcept {
         R"(Space <loop set="lvl2[strings]" value="val" key="id">l-id): val#</loop><loop set ="lvl2[numbers]" value="val2" key="id2">l-id2): val2# </loop>)");
     bit.Expected.Add("Space l-0): N1#l-1): N2#l-2): N3#l-0): 1# l-1): 2# ");
 
+    // The head of the loop runs into its tail.
+    bit.Content.Add(R"(<loop{iif case="1" true="T" false="F"}}<</loop>)");
+    bit.Expected.Add("");
+
     ////
 
     bit.Content.Add(R"( <if case="1"> 5 </if> )")
@@ -459,6 +464,25 @@ static Array<TestBit> GetEngineBits() noexcept {
     bit      = TestBit();
     bit.Line = __LINE__;
 
+    bit.Content.Add("<l></l>").Add("<l></l").Add("<l><</l>").Add("<l></</l>").Add("<l></<l></l> a");
+    bit.Expected.Add("-").Add("<l></l").Add("-").Add("-").Add("- a");
+    bit.Content.Add("<l>abcdefghijklmnopqrstuvwxyz0123456789</ abcdefghijklmnopqrstuvwxyz0123456789</l>-");
+    bit.Expected.Add("--");
+    bit.Content.Add("a <l>abcdefghijklmnopqrstuvwxyz0123456789/l> abcdefghijklmnopqrstuvwxyz0123456789</l");
+    bit.Expected.Add("a <l>abcdefghijklmnopqrstuvwxyz0123456789/l> abcdefghijklmnopqrstuvwxyz0123456789</l");
+
+    Memory::AllocateBit<Expression>(&x1);
+    x1->SetHead("<l>");
+    x1->SetTail("</l>");
+    x1->SetReplace("-");
+
+    bit.Expres.Add(x1);
+    bit.Collect.Add(x1);
+    bits += static_cast<TestBit &&>(bit);
+    ///////////////////////////////////////////
+    bit      = TestBit();
+    bit.Line = __LINE__;
+
     bit.Content.Add("<").Add("<>>").Add("<>> ").Add(" <>>").Add(" <>> ").Add("  <>>  ");
     bit.Expected.Add("<").Add("-").Add("- ").Add(" -").Add(" - ").Add("  -  ");
     bit.Content.Add("<a").Add("a<aa").Add("<aa>> a").Add("a <a>>").Add("a <a>> a").Add("a {8} <aa>>  a");
@@ -1147,6 +1171,35 @@ static Array<TestBit> GetEngineBits() noexcept {
     bit.Collect.Add(x1).Add(x2).Add(x3);
     bits += static_cast<TestBit &&>(bit);
     ///////////////////////////////////////////
+    // From one to eight lead bytes, with content longer than a vector block.
+    static const char *leads[]    = {"a", "b", "c", "d", "e", "f", "g", "h"};
+    static const char *expected[] = {"........................................*bcdefgh........................................",
+                                     "........................................**cdefgh........................................",
+                                     "........................................***defgh........................................",
+                                     "........................................****efgh........................................",
+                                     "........................................*****fgh........................................",
+                                     "........................................******gh........................................",
+                                     "........................................*******h........................................",
+                                     "........................................********........................................"};
+
+    for (UNumber i = 0; i < 8; i++) {
+        bit      = TestBit();
+        bit.Line = __LINE__;
+        bit.Content.Add("........................................abcdefgh........................................");
+        bit.Expected.Add(expected[i]);
+
+        for (UNumber j = 0; j <= i; j++) {
+            Memory::AllocateBit<Expression>(&x1);
+            x1->SetHead(leads[j]);
+            x1->SetReplace("*");
+
+            bit.Expres.Add(x1);
+            bit.Collect.Add(x1);
+        }
+
+        bits += static_cast<TestBit &&>(bit);
+    }
+    ///////////////////////////////////////////
     return bits;
 }
 